@@ -0,0 +1,156 @@
+/*
+Parse throughput on recorded RemoteHWInfo documents.
+
+    python3 tools/remotehwinfo-standin.py --readings 5000 --dump d5000.json
+    g++ -O2 -mavx2 -I. bench/json-parse-bench.cpp json-parser/json.c -o json-parse-bench
+    json-parse-bench d5000.json [runs [later polls...]]
+
+Build without -mavx2 for the SSE2 scanner, or with -DJSON_NO_SIMD for the plain loops, and with
+-DJSON_STRTOD_NUMBERS to convert doubles with strtod instead of Eisel-Lemire. The streaming
+modes are fed in 16 KB chunks, as the poller gets them from curl, and allocate from a reused
+arena, as the poller does. Fast reparse is the lazy tape with json_fast_reparse: every run after
+the first patches a document's numbers into the tape the first one parsed, the same document's
+or, given later polls (--dump d5000.json --polls 8), theirs in turn.
+*/
+#include "json-parser/json.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+const size_t CHUNK_SIZE = 16 * 1024;
+
+enum ParseMode {
+    CLASSIC,
+    SINGLE_PASS,
+    STREAM_TREE,
+    STREAM_IN_SITU,
+    STREAM_TAPE,
+    LAZY_TAPE,
+    FAST_REPARSE
+};
+const char *MODE_NAMES[] = {"json_parse_ex", "single pass", "stream",      "stream in-situ",
+                            "stream tape",   "lazy tape",   "fast reparse"};
+
+static const char *simdLevel() {
+#if defined(JSON_NO_SIMD)
+    return "none";
+#elif defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__) || defined(_M_X64)
+    return "SSE2";
+#else
+    return "none";
+#endif
+}
+
+static char *readFile(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    *size = (size_t)ftell(file);
+    rewind(file);
+    char *contents = (char *)malloc(*size);
+    if (contents != NULL && fread(contents, 1, *size, file) != *size) {
+        free(contents);
+        contents = NULL;
+    }
+    fclose(file);
+    return contents;
+}
+
+// Returns the fastest of runs parses in seconds, or a negative number if parsing failed. Fast
+// reparse runs after the first take the later polls in turn, if there are any.
+static double timeParse(ParseMode mode, const char *json, size_t size, int runs,
+                        char *const *polls, const size_t *pollSizes, int pollCount) {
+    json_arena *arena = json_arena_new(0);
+    json_settings settings = {0};
+    json_arena_settings(arena, &settings);
+    if (mode == SINGLE_PASS)
+        settings.settings = json_single_pass;
+    if (mode == STREAM_IN_SITU)
+        settings.settings = json_in_situ;
+    if (mode == STREAM_TAPE)
+        settings.settings = json_emit_tape;
+    if (mode == LAZY_TAPE)
+        settings.settings = json_emit_tape | json_lazy_numbers;
+    if (mode == FAST_REPARSE)
+        settings.settings = json_emit_tape | json_lazy_numbers | json_fast_reparse;
+    json_stream *stream = json_stream_new(&settings);
+
+    double best = -1;
+    for (int run = 0; run < runs; run++) {
+        json_arena_reset(arena);
+        if (mode == FAST_REPARSE && run > 0 && pollCount > 0) {
+            json = polls[(run - 1) % pollCount];
+            size = pollSizes[(run - 1) % pollCount];
+        }
+        auto start = std::chrono::steady_clock::now();
+        void *result;
+        if (mode == CLASSIC || mode == SINGLE_PASS) {
+            result = json_parse_ex(&settings, json, size, NULL);
+        } else {
+            for (size_t offset = 0; offset < size; offset += CHUNK_SIZE)
+                json_stream_feed(stream, json + offset,
+                                 size - offset < CHUNK_SIZE ? size - offset : CHUNK_SIZE);
+            if (mode == STREAM_TAPE || mode == LAZY_TAPE || mode == FAST_REPARSE)
+                result = json_stream_finish_tape(stream, NULL);
+            else
+                result = json_stream_finish(stream, NULL);
+        }
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (result == NULL) {
+            best = -1;
+            break;
+        }
+        if (best < 0 || seconds < best)
+            best = seconds;
+    }
+
+    json_stream_free(stream);
+    json_arena_free(arena);
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s document.json [runs [later polls...]]\n", argv[0]);
+        return 2;
+    }
+    int runs = argc > 2 ? atoi(argv[2]) : 20;
+    size_t size;
+    char *json = readFile(argv[1], &size);
+    if (json == NULL) {
+        fprintf(stderr, "ERROR: could not read %s\n", argv[1]);
+        return 1;
+    }
+
+    int pollCount = argc > 3 ? argc - 3 : 0;
+    char **polls = new char *[pollCount + 1];
+    size_t *pollSizes = new size_t[pollCount + 1];
+    for (int i = 0; i < pollCount; i++) {
+        if ((polls[i] = readFile(argv[i + 3], &pollSizes[i])) == NULL) {
+            fprintf(stderr, "ERROR: could not read %s\n", argv[i + 3]);
+            return 1;
+        }
+    }
+
+    printf("%s: %llu bytes, best of %d, SIMD: %s\n", argv[1], (unsigned long long)size, runs,
+           simdLevel());
+    for (int mode = CLASSIC; mode <= FAST_REPARSE; mode++) {
+        double seconds = timeParse((ParseMode)mode, json, size, runs, polls, pollSizes, pollCount);
+        if (seconds < 0) {
+            printf("%-16s failed to parse\n", MODE_NAMES[mode]);
+            continue;
+        }
+        printf("%-16s %9.3f ms %8.3f GB/s\n", MODE_NAMES[mode], seconds * 1000,
+               size / seconds / 1e9);
+    }
+    for (int i = 0; i < pollCount; i++)
+        free(polls[i]);
+    delete[] polls;
+    delete[] pollSizes;
+    free(json);
+    return 0;
+}
@@ -0,0 +1,109 @@
+/*
+How json_parse_tape_parallel scales with threads on a large hwinfo.readings array.
+
+    python3 tools/remotehwinfo-standin.py --readings 100000 --dump d100000.json
+    g++ -O2 -mavx2 -I. bench/parallel-parse-bench.cpp json-parser/json.c -lpthread \
+        -o parallel-parse-bench
+    parallel-parse-bench d100000.json [max threads] [runs]
+
+Each thread count n splits the readings into n runs and parses them on a pool of n - 1 threads
+plus the calling one (one thread parses the document in one piece, through the same call). The
+baseline is the lazy tape stream fed the whole document, as the poller does.
+*/
+#include "json-parser/json.h"
+#include "worker-pool.hpp"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+static char *readFile(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    *size = (size_t)ftell(file);
+    rewind(file);
+    char *contents = (char *)malloc(*size);
+    if (contents != NULL && fread(contents, 1, *size, file) != *size) {
+        free(contents);
+        contents = NULL;
+    }
+    fclose(file);
+    return contents;
+}
+
+// Returns the fastest of runs parses in seconds, or a negative number if parsing failed. With
+// threads 0, the document is fed to a stream instead.
+static double timeParse(const char *json, size_t size, size_t readings, unsigned threads,
+                        int runs) {
+    json_arena *arena = json_arena_new(0);
+    json_settings settings = {0};
+    json_arena_settings(arena, &settings);
+    settings.settings = json_emit_tape | json_lazy_numbers;
+    json_stream *stream = json_stream_new(&settings);
+    WorkerPool pool(threads > 1 ? threads - 1 : 0);
+
+    double best = -1;
+    for (int run = 0; run < runs; run++) {
+        json_arena_reset(arena);
+        auto start = std::chrono::steady_clock::now();
+        json_tape *tape;
+        if (threads == 0) {
+            json_stream_feed(stream, json, size);
+            tape = json_stream_finish_tape(stream, NULL);
+        } else {
+            tape = json_parse_tape_parallel(&settings, json, size, readings, threads,
+                                            WorkerPool::runParts, &pool, NULL);
+        }
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (tape == NULL) {
+            best = -1;
+            break;
+        }
+        if (best < 0 || seconds < best)
+            best = seconds;
+    }
+
+    json_stream_free(stream);
+    json_arena_free(arena);
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s document.json [max threads] [runs]\n", argv[0]);
+        return 2;
+    }
+    unsigned maxThreads =
+        argc > 2 ? (unsigned)atoi(argv[2]) : std::thread::hardware_concurrency();
+    int runs = argc > 3 ? atoi(argv[3]) : 10;
+    size_t size;
+    char *json = readFile(argv[1], &size);
+    if (json == NULL) {
+        fprintf(stderr, "ERROR: could not read %s\n", argv[1]);
+        return 1;
+    }
+
+    json_text document = {json, size};
+    size_t hwinfo = json_text_find(&document, json_text_root(&document), "hwinfo");
+    size_t readings = json_text_find(&document, hwinfo, "readings");
+    if (json_text_type(&document, readings) != json_array) {
+        fprintf(stderr, "ERROR: %s has no hwinfo.readings array\n", argv[1]);
+        return 1;
+    }
+
+    printf("%s: %llu bytes, best of %d\n", argv[1], (unsigned long long)size, runs);
+    double single = timeParse(json, size, readings, 0, runs);
+    printf("%-12s %9.3f ms\n", "lazy tape", single * 1000);
+    for (unsigned threads = 1; threads <= (maxThreads ? maxThreads : 1); threads++) {
+        double seconds = timeParse(json, size, readings, threads, runs);
+        if (seconds < 0) {
+            printf("%2u threads   failed to parse\n", threads);
+            continue;
+        }
+        printf("%2u threads   %9.3f ms %6.2fx\n", threads, seconds * 1000, single / seconds);
+    }
+    free(json);
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*
+What keeping sensor history costs: appending a sample of every sensor, and reading the min, max
+and mean of every sensor over every window, at 10 Hz.
+
+    g++ -O2 -I. bench/sensor-history-bench.cpp sensor-history.cpp -o sensor-history-bench
+    sensor-history-bench [sensors] [minutes kept] [ticks]
+
+Sensors random-walk in hundredths, with one sample in twenty invalid. Windows are one minute and
+everything kept (five minutes by default), plus the session. The same reads done by scanning the
+samples are timed on a few ticks for comparison, and check every read of those ticks.
+*/
+#include "sensor-history.hpp"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+const long long TICK_MS = 100;
+const int SCAN_EVERY = 97;
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The valid samples of a sensor among the last capacity, newer than windowMs before the last.
+static SensorWindowStats scanWindow(const std::vector<int32_t> &values,
+                                    const std::vector<uint32_t> &valid, unsigned sensors,
+                                    unsigned validWords, unsigned long long appended,
+                                    unsigned capacity, unsigned sensor, long long windowMs) {
+    SensorWindowStats stats = {0, 0, 0, 0};
+    unsigned long long first = appended > capacity ? appended - capacity : 0;
+    long long oldest = (long long)(appended - 1) * TICK_MS - windowMs;
+    for (unsigned long long sample = first; sample < appended; sample++) {
+        if (windowMs >= 0 && (long long)sample * TICK_MS <= oldest)
+            continue;
+        if (!(valid[sample * validWords + sensor / 32] >> (sensor % 32) & 1))
+            continue;
+        int32_t value = values[sample * sensors + sensor];
+        if (stats.count == 0 || value < stats.min)
+            stats.min = value;
+        if (stats.count == 0 || value > stats.max)
+            stats.max = value;
+        stats.sum += value;
+        stats.count++;
+    }
+    return stats;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned sensors = argc > 1 ? (unsigned)atoi(argv[1]) : 300;
+    unsigned minutes = argc > 2 ? (unsigned)atoi(argv[2]) : 5;
+    SensorHistoryConfig config = {};
+    config.capacity = minutes * 60 * 1000 / TICK_MS;
+    config.windowCount = 2;
+    config.windowMs[0] = 60 * 1000;
+    config.windowMs[1] = (long long)minutes * 60 * 1000;
+    unsigned long long ticks = argc > 3 ? strtoull(argv[3], NULL, 10) : 3ull * config.capacity;
+    if (sensors == 0 || config.capacity == 0) {
+        fprintf(stderr, "usage: %s [sensors] [minutes kept] [ticks]\n", argv[0]);
+        return 2;
+    }
+
+    SensorHistory history;
+    if (!sensorHistoryInit(&history, sensors, &config)) {
+        fprintf(stderr, "ERROR: could not allocate %llu bytes of history\n",
+                (unsigned long long)sensorHistoryBytes(sensors, &config));
+        return 1;
+    }
+    printf("%u sensors, %u samples each, %llu ticks: %llu bytes of history\n", sensors,
+           config.capacity, ticks, (unsigned long long)history.bytes);
+
+    // Every sample is kept here too, for the scans.
+    unsigned validWords = history.validWords;
+    std::vector<int32_t> values((size_t)ticks * sensors);
+    std::vector<uint32_t> valid((size_t)ticks * validWords);
+    std::vector<int32_t> walk(sensors, 5000);
+    srand(1);
+
+    double appendSeconds = 0, querySeconds = 0, scanSeconds = 0;
+    unsigned long long scans = 0, mismatches = 0;
+    volatile int64_t sink = 0;
+    for (unsigned long long tick = 0; tick < ticks; tick++) {
+        int32_t *tickValues = &values[(size_t)tick * sensors];
+        uint32_t *tickValid = &valid[(size_t)tick * validWords];
+        for (unsigned sensor = 0; sensor < sensors; sensor++) {
+            walk[sensor] += rand() % 201 - 100;
+            tickValues[sensor] = walk[sensor];
+            if (rand() % 20 != 0)
+                tickValid[sensor / 32] |= 1u << (sensor % 32);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        sensorHistoryAppend(&history, (long long)tick * TICK_MS, tickValues, tickValid);
+        appendSeconds += secondsSince(start);
+
+        SensorWindowStats stats[SENSOR_HISTORY_MAX_WINDOWS + 1];
+        bool found[SENSOR_HISTORY_MAX_WINDOWS + 1];
+        int64_t total = 0;
+        start = std::chrono::steady_clock::now();
+        for (unsigned sensor = 0; sensor < sensors; sensor++) {
+            for (int window = -1; window < (int)config.windowCount; window++) {
+                if (sensorHistoryWindow(&history, sensor, window, &stats[window + 1]))
+                    total += stats[window + 1].min + stats[window + 1].max +
+                             sensorWindowAggregate(&stats[window + 1], SENSOR_MEAN);
+            }
+        }
+        querySeconds += secondsSince(start);
+        sink = sink + total;
+
+        if (tick % SCAN_EVERY != 0 && tick + 1 != ticks)
+            continue;
+        scans++;
+        for (unsigned sensor = 0; sensor < sensors; sensor++) {
+            start = std::chrono::steady_clock::now();
+            SensorWindowStats scanned[SENSOR_HISTORY_MAX_WINDOWS + 1];
+            scanned[0] = scanWindow(values, valid, sensors, validWords, tick + 1, (unsigned)ticks,
+                                    sensor, -1);
+            for (unsigned window = 0; window < config.windowCount; window++)
+                scanned[window + 1] = scanWindow(values, valid, sensors, validWords, tick + 1,
+                                                 config.capacity, sensor, config.windowMs[window]);
+            scanSeconds += secondsSince(start);
+            for (int window = -1; window < (int)config.windowCount; window++) {
+                found[window + 1] =
+                    sensorHistoryWindow(&history, sensor, window, &stats[window + 1]);
+                const SensorWindowStats &a = stats[window + 1], &b = scanned[window + 1];
+                if (found[window + 1] != (b.count > 0) ||
+                    (b.count > 0 && (a.count != b.count || a.sum != b.sum || a.min != b.min ||
+                                     a.max != b.max))) {
+                    if (mismatches++ < 10)
+                        printf("MISMATCH tick %llu sensor %u window %d: %u %lld %d %d, scanned "
+                               "%u %lld %d %d\n",
+                               tick, sensor, window, a.count, (long long)a.sum, a.min, a.max,
+                               b.count, (long long)b.sum, b.min, b.max);
+                }
+            }
+        }
+    }
+
+    int reads = (int)config.windowCount + 1;
+    printf("append  %9.2f us/tick %7.1f ns/sensor\n", appendSeconds / ticks * 1e6,
+           appendSeconds / ticks / sensors * 1e9);
+    printf("query   %9.2f us/tick %7.1f ns/read (%d windows per sensor)\n",
+           querySeconds / ticks * 1e6, querySeconds / ticks / sensors / reads * 1e9, reads);
+    printf("scan    %9.2f us/tick %7.1f ns/read, on %llu ticks\n", scanSeconds / scans * 1e6,
+           scanSeconds / scans / sensors / reads * 1e9, scans);
+    printf("at 10 Hz: %.4f%% of one core to append and query\n",
+           (appendSeconds + querySeconds) / ticks * 10 * 100);
+    printf("%llu mismatches\n", mismatches);
+    sensorHistoryFree(&history);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,192 @@
+/*
+What it costs to get the values both screens show out of a recorded RemoteHWInfo document: parse
+it (if at all) and look every sensor up once, as one display tick does.
+
+    python3 tools/remotehwinfo-standin.py --readings 5000 --dump d5000.json
+    g++ -O2 -mavx2 -I. bench/sensor-lookup-bench.cpp remotehwinfo-parser.cpp json-parser/json.c \
+        -o sensor-lookup-bench
+    sensor-lookup-bench d5000.json [runs]
+
+The tree and the tape are parsed into a reused arena, whose high-water mark is the memory each
+needs per document; on-demand lookups read the text in place and need none. Sensor handles read
+the tape too, but look each sensor up by name only on the first tick; every later one is a check
+of the name at the index found then. The batch mode looks every sensor up by name on every tick:
+the Afterburner entries in one walk over them, matching each name with one probe of a perfect hash
+table built at compile time, and the HWiNFO readings through the group index built for the tick's
+document.
+*/
+#include "json-parser/json.h"
+#include "remotehwinfo-parser.hpp"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+// The same sensors createScreen1 and createScreen2 read.
+constexpr char NETWORK_GROUP[] = "Network: Broadcom 802.11ac Wireless PCIE Full Dongle Adapter";
+constexpr SensorDescriptor SCREEN_SENSORS[] = {
+    afterburnerSensor("GPU temperature"),
+    afterburnerSensor("GPU usage"),
+    afterburnerSensor("Framerate"),
+    afterburnerSensor("CPU temperature"),
+    afterburnerSensor("CPU usage"),
+    afterburnerSensor("Fan speed"),
+    hwinfoSensor("System", "Physical Memory Used"),
+    hwinfoSensor("System", "Physical Memory Available"),
+    afterburnerSensor("Core clock"),
+    afterburnerSensor("Memory clock"),
+    hwinfoSensor("ASRock X570 Steel Legend (Nuvoton NCT6796D)", "CPU2"),
+    afterburnerSensor("CPU clock"),
+    hwinfoSensor(NETWORK_GROUP, "Current UP rate"),
+    hwinfoSensor(NETWORK_GROUP, "Current DL rate"),
+};
+const int SCREEN_SENSOR_COUNT = sizeof(SCREEN_SENSORS) / sizeof(SCREEN_SENSORS[0]);
+constexpr SensorTable<SCREEN_SENSOR_COUNT> SCREEN_SENSOR_TABLE = makeSensorTable(SCREEN_SENSORS);
+constexpr SensorTableView SCREEN_SENSOR_VIEW = SCREEN_SENSOR_TABLE.view();
+
+enum LookupMode { TREE, TAPE, BATCH, HANDLES, ON_DEMAND };
+const char *MODE_NAMES[] = {"tree", "tape", "batch", "handles", "on demand"};
+
+static char *readFile(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    *size = (size_t)ftell(file);
+    rewind(file);
+    char *contents = (char *)malloc(*size);
+    if (contents != NULL && fread(contents, 1, *size, file) != *size) {
+        free(contents);
+        contents = NULL;
+    }
+    fclose(file);
+    return contents;
+}
+
+// Looks every screen sensor up once and returns their sum, so the lookups cannot be dropped.
+static double lookUpTree(json_value *document) {
+    json_value *afterburner = getValueOfKeyIfHasType(document, "afterburner", json_object);
+    json_value *hwinfo = getValueOfKeyIfHasType(document, "hwinfo", json_object);
+    double sum = 0;
+    for (int i = 0; i < SCREEN_SENSOR_COUNT; i++) {
+        const SensorDescriptor &sensor = SCREEN_SENSORS[i];
+        sum += sensor.source == AFTERBURNER_SENSOR
+                   ? getAfterburnerSensorValue(afterburner, sensor.label.name)
+                   : getHwinfoSensorValue(hwinfo, sensor.label.name, sensor.group.name);
+    }
+    return sum;
+}
+
+static double lookUpTape(const json_tape *document) {
+    size_t afterburner = getValueOfKeyIfHasType(document, 0, "afterburner", json_object);
+    size_t hwinfo = getValueOfKeyIfHasType(document, 0, "hwinfo", json_object);
+    double sum = 0;
+    for (int i = 0; i < SCREEN_SENSOR_COUNT; i++) {
+        const SensorDescriptor &sensor = SCREEN_SENSORS[i];
+        sum += sensor.source == AFTERBURNER_SENSOR
+                   ? getAfterburnerSensorValue(document, afterburner, sensor.label.name)
+                   : getHwinfoSensorValue(document, hwinfo, sensor.label.name, sensor.group.name);
+    }
+    return sum;
+}
+
+// Indexes the readings by group first, as the poller does for every document.
+static double lookUpHandles(const json_tape *document, json_arena *arena, SensorHandle *handles,
+                            bool forget) {
+    double values[SCREEN_SENSOR_COUNT];
+    double sum = 0;
+    if (forget)
+        initSensorHandles(handles, &SCREEN_SENSOR_VIEW);
+    const HwinfoIndex *hwinfoIndex = buildHwinfoIndex(document, arena);
+    getSensorValues(document, hwinfoIndex, &SCREEN_SENSOR_VIEW, handles, values);
+    for (int i = 0; i < SCREEN_SENSOR_COUNT; i++)
+        sum += values[i];
+    return sum;
+}
+
+static double lookUpText(const json_text *document) {
+    size_t root = json_text_root(document);
+    size_t afterburner = getValueOfKeyIfHasType(document, root, "afterburner", json_object);
+    size_t hwinfo = getValueOfKeyIfHasType(document, root, "hwinfo", json_object);
+    double sum = 0;
+    for (int i = 0; i < SCREEN_SENSOR_COUNT; i++) {
+        const SensorDescriptor &sensor = SCREEN_SENSORS[i];
+        sum += sensor.source == AFTERBURNER_SENSOR
+                   ? getAfterburnerSensorValue(document, afterburner, sensor.label.name)
+                   : getHwinfoSensorValue(document, hwinfo, sensor.label.name, sensor.group.name);
+    }
+    return sum;
+}
+
+// Returns the fastest of runs ticks in seconds, or a negative number if parsing failed.
+static double timeTick(LookupMode mode, const char *json, size_t size, int runs, double *sum,
+                       size_t *memory) {
+    json_arena *arena = json_arena_new(0);
+    json_settings settings = {0};
+    json_arena_settings(arena, &settings);
+    settings.settings = json_emit_tape | json_lazy_numbers;
+    json_stream *stream = json_stream_new(&settings);
+    settings.settings = 0;
+    SensorHandle handles[SCREEN_SENSOR_COUNT];
+    initSensorHandles(handles, &SCREEN_SENSOR_VIEW);
+
+    double best = -1;
+    for (int run = 0; run < runs; run++) {
+        json_arena_reset(arena);
+        auto start = std::chrono::steady_clock::now();
+        if (mode == TREE) {
+            json_value *document = json_parse_ex(&settings, json, size, NULL);
+            if (document == NULL)
+                break;
+            *sum = lookUpTree(document);
+        } else if (mode != ON_DEMAND) {
+            json_stream_feed(stream, json, size);
+            json_tape *document = json_stream_finish_tape(stream, NULL);
+            if (document == NULL)
+                break;
+            *sum = mode == TAPE ? lookUpTape(document)
+                                : lookUpHandles(document, arena, handles, mode == BATCH);
+        } else {
+            json_text document = {json, size};
+            *sum = lookUpText(&document);
+        }
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (best < 0 || seconds < best)
+            best = seconds;
+    }
+
+    *memory = mode == ON_DEMAND ? 0 : json_arena_high_water(arena);
+    json_stream_free(stream);
+    json_arena_free(arena);
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s document.json [runs]\n", argv[0]);
+        return 2;
+    }
+    int runs = argc > 2 ? atoi(argv[2]) : 20;
+    size_t size;
+    char *json = readFile(argv[1], &size);
+    if (json == NULL) {
+        fprintf(stderr, "ERROR: could not read %s\n", argv[1]);
+        return 1;
+    }
+
+    printf("%s: %llu bytes, %d sensors, best of %d\n", argv[1], (unsigned long long)size,
+           SCREEN_SENSOR_COUNT, runs);
+    for (int mode = TREE; mode <= ON_DEMAND; mode++) {
+        double sum = 0;
+        size_t memory = 0;
+        double seconds = timeTick((LookupMode)mode, json, size, runs, &sum, &memory);
+        if (seconds < 0) {
+            printf("%-10s failed to parse\n", MODE_NAMES[mode]);
+            continue;
+        }
+        printf("%-10s %9.3f ms per tick %10llu bytes of arena (sum %g)\n", MODE_NAMES[mode],
+               seconds * 1000, (unsigned long long)memory, sum);
+    }
+    free(json);
+    return 0;
+}
@@ -80,6 +80,39 @@ typedef struct
 } json_settings;
 
 #define json_enable_comments  0x01
+#define json_in_situ          0x02  /* json_stream only, see below */
+#define json_emit_tape        0x04  /* json_stream only, see below */
+
+/* json_parse_ex reads the input twice, first to size every allocation
+ * exactly and then to fill them in.  With json_single_pass it reads it once
+ * through the streaming parser instead, which collects children on scratch
+ * stacks and copies them out as each container closes: the same tree in
+ * roughly half the time, for a few transient allocations.
+ */
+#define json_single_pass      0x08
+
+/* With json_lazy_numbers (json_emit_tape only) the tape keeps doubles as
+ * text, and json_tape_double converts one each time it is read: for
+ * documents where most numbers are never looked at.
+ */
+#define json_lazy_numbers     0x10
+
+/* Every object member records a hash of its name, so json_object_find (and
+ * json_tape_find) compare a hash and a length per member and at most one
+ * name; a json_key saves hashing the same name for every object searched.
+ * With json_index_objects, objects of JSON_INDEX_MIN_MEMBERS members or more
+ * also get a small open-addressed table of their members, for one probe or
+ * two instead of a scan.
+ */
+#define json_index_objects    0x20
+
+/* With json_fast_reparse (json_emit_tape only) the stream remembers the last
+ * document it parsed in full, and one that differs from it only in its
+ * numbers is not parsed again: json_stream_finish_tape scans it and patches
+ * them into a copy of the last tape.  For polling a source whose layout
+ * rarely changes; see json_stream_reparse_counts.
+ */
+#define json_fast_reparse     0x40
 
 typedef enum
 {
@@ -96,10 +129,28 @@ typedef enum
 
 extern const struct _json_value json_value_none;
 
+/* A member name hashed once, for looking it up in many objects */
+typedef struct
+{
+   const json_char * name;
+   unsigned int length, hash;
+
+} json_key;
+
+json_key json_key_make (const json_char * name);
+
+/* The value of the member named key, or 0 */
+struct _json_value * json_object_find (const struct _json_value * object,
+                                       const json_char * key);
+
+struct _json_value * json_object_find_key (const struct _json_value * object,
+                                           const json_key * key);
+
 typedef struct _json_object_entry
 {
     json_char * name;
     unsigned int name_length;
+    unsigned int name_hash;
 
     struct _json_value * value;
 
@@ -127,6 +178,7 @@ typedef struct _json_value
       struct
       {
          unsigned int length;
+         unsigned int index_mask;  /* with an index, which follows values */
 
          json_object_entry * values;
 
@@ -198,14 +250,9 @@ typedef struct _json_value
 
          inline const struct _json_value &operator [] (const char * index) const
          {
-            if (type != json_object)
-               return json_value_none;
-
-            for (unsigned int i = 0; i < u.object.length; ++ i)
-               if (!strcmp (u.object.values [i].name, index))
-                  return *u.object.values [i].value;
+            const struct _json_value * value = json_object_find (this, index);
 
-            return json_value_none;
+            return value ? *value : json_value_none;
          }
 
          inline operator const char * () const
@@ -281,6 +328,197 @@ void json_value_free_ex (json_settings * settings,
                          json_value *);
 
 
+/* Streaming parser: feed the document in chunks of any size as they arrive,
+ * then call json_stream_finish for the tree (which is freed with
+ * json_value_free as usual).  json_stream_feed returns 0 once the input is
+ * known to be invalid; the message is reported by json_stream_finish.  A
+ * stream resets itself after json_stream_finish and is meant to be reused.
+ */
+typedef struct _json_stream json_stream;
+
+/* With json_in_situ set in settings.settings, the stream keeps a single copy
+ * of the document (allocated with settings.mem_alloc) and every string value
+ * and object name points into it, decoded and null terminated in place,
+ * instead of being allocated on its own.  The copy belongs to the tree: free
+ * such a tree with json_value_free_ex and the same settings (which releases
+ * the copy along with the root), or let an arena reset take both.
+ */
+
+json_stream * json_stream_new (json_settings * settings);
+
+int json_stream_feed (json_stream * stream,
+                      const json_char * chunk,
+                      size_t length);
+
+json_value * json_stream_finish (json_stream * stream,
+                                 char * error);
+
+void json_stream_reset (json_stream * stream);
+void json_stream_free (json_stream * stream);
+
+
+/* Tape output: with json_emit_tape set (which implies json_in_situ), the
+ * stream builds no json_value tree but one array of tagged 64-bit words in
+ * document order, which is scanned front to back instead of pointer by
+ * pointer.  Containers know where they end, so whole subtrees are skipped in
+ * one step, and strings are views into the stream's copy of the document
+ * (still null terminated).  Values are addressed by word index, the root
+ * being 0; lookups that find nothing return json_tape_none, which every
+ * function below accepts.
+ *
+ *    size_t readings = json_tape_find (tape, json_tape_find (tape, 0, "hwinfo"), "readings");
+ *
+ *    for (size_t i = json_tape_first (tape, readings); i != json_tape_none;
+ *         i = json_tape_next (tape, i))
+ *       ...
+ *
+ * Object members are iterated by key with json_tape_next_key; the value of
+ * key k is at k + 2.
+ */
+typedef unsigned long long json_tape_word;
+
+typedef struct _json_tape
+{
+   json_tape_word * words;
+   size_t length;
+
+   const json_char * strings;  /* the document copy strings point into */
+
+} json_tape;
+
+#define json_tape_none ((size_t) -1)
+
+json_tape * json_stream_finish_tape (json_stream * stream,
+                                     char * error);
+
+/* How many documents a json_fast_reparse stream has patched into the last
+ * tape, and how many it has had to parse in full (the first, and every one
+ * whose layout changed)
+ */
+void json_stream_reparse_counts (const json_stream * stream,
+                                 unsigned long * patched,
+                                 unsigned long * parsed);
+
+/* Parallel parsing: builds the tape a json_emit_tape stream would for the
+ * whole document, with the elements of the array at offset array (found
+ * with json_text_find, say) parsed in up to parts runs at the same time.
+ * run_parts calls task on each of count runs, on whatever threads it has,
+ * and returns once they have all finished; it is called once to parse the
+ * runs (which allocate with malloc) and once to copy them into the result
+ * (allocated with settings).  Anything that cannot be split is parsed in one
+ * piece, as is a document with a run that fails, for the real error.
+ */
+typedef void (* json_run_parts) (void (* task) (void * run), void ** runs,
+                                 unsigned int count, void * run_data);
+
+json_tape * json_parse_tape_parallel (json_settings * settings,
+                                      const json_char * json,
+                                      size_t length,
+                                      size_t array,
+                                      unsigned int parts,
+                                      json_run_parts run_parts,
+                                      void * run_data,
+                                      char * error);
+
+void json_tape_free (json_tape *);
+void json_tape_free_ex (json_settings * settings, json_tape *);
+
+json_type json_tape_type (const json_tape *, size_t value);
+size_t json_tape_skip (const json_tape *, size_t value);  /* the word after value */
+
+size_t json_tape_first (const json_tape *, size_t container);
+size_t json_tape_next (const json_tape *, size_t value);
+size_t json_tape_next_key (const json_tape *, size_t key);
+unsigned int json_tape_length (const json_tape *, size_t container);
+
+size_t json_tape_find (const json_tape *, size_t object, const json_char * key);
+size_t json_tape_find_key (const json_tape *, size_t object, const json_key * key);
+
+/* Whether value is the value of an object member named key: one compare of
+ * the word before it, so an index kept from an earlier tape of the same
+ * layout is checked without searching the object again
+ */
+int json_tape_is_member (const json_tape *, size_t value, const json_key * key);
+
+const json_char * json_tape_string (const json_tape *, size_t value, unsigned int * length);
+json_int_t json_tape_integer (const json_tape *, size_t value);
+double json_tape_double (const json_tape *, size_t value);  /* integers too */
+int json_tape_boolean (const json_tape *, size_t value);
+
+
+/* On-demand navigation: values are read straight out of the document text,
+ * addressed by their offset in it, and nothing else is parsed.  Stepping
+ * over a value matches brackets instead of building anything, so looking a
+ * few values up in a large document allocates nothing and takes no memory
+ * beyond the text itself.  Only what each step reads is checked, so on
+ * malformed text lookups come back empty rather than failing (parse the
+ * document if it has to be validated); comments are not supported.
+ *
+ *    json_text text = { json, length };
+ *    size_t hwinfo = json_text_find (&text, json_text_root (&text), "hwinfo");
+ *
+ * The functions follow the tape's, with json_text_none for json_tape_none,
+ * except that object members are iterated by key with json_text_next and a
+ * key's value is found with json_text_value.  Every lookup starts over from
+ * the text, so keep the offsets of values that are read repeatedly.
+ */
+typedef struct
+{
+   const json_char * json;
+   size_t length;
+
+} json_text;
+
+#define json_text_none ((size_t) -1)
+
+size_t json_text_root (const json_text *);
+
+json_type json_text_type (const json_text *, size_t value);
+size_t json_text_skip (const json_text *, size_t value);  /* the offset after value */
+
+size_t json_text_first (const json_text *, size_t container);
+size_t json_text_next (const json_text *, size_t value);
+size_t json_text_value (const json_text *, size_t key);
+
+size_t json_text_find (const json_text *, size_t object, const json_char * key);
+size_t json_text_find_key (const json_text *, size_t object, const json_key * key);
+
+/* Strings are decoded as they are read: json_text_string copies at most
+ * size - 1 characters and a null terminator to buf and returns the full
+ * decoded length.
+ */
+int json_text_string_equals (const json_text *, size_t value,
+                             const json_char * string, size_t length);
+size_t json_text_string (const json_text *, size_t value, json_char * buf, size_t size);
+
+json_int_t json_text_integer (const json_text *, size_t value);
+double json_text_double (const json_text *, size_t value);  /* integers too */
+int json_text_boolean (const json_text *, size_t value);
+
+
+/* Arena allocator for json_settings: every value of a document comes out of
+ * retained blocks and the whole document is released in O(1) by
+ * json_arena_reset instead of json_value_free.  Reusing one arena per poll
+ * stops parsing from calling malloc/free at all once the blocks are large
+ * enough.
+ */
+typedef struct _json_arena json_arena;
+
+json_arena * json_arena_new (size_t block_size);  /* 0 for the default */
+
+void json_arena_settings (json_arena * arena, json_settings * settings);
+
+void * json_arena_alloc (size_t size, int zero, void * arena);
+void json_arena_release (void * ptr, void * arena);
+
+void json_arena_reset (json_arena * arena);
+
+size_t json_arena_high_water (const json_arena * arena);
+unsigned long json_arena_blocks_allocated (const json_arena * arena);
+
+void json_arena_free (json_arena * arena);
+
+
 #ifdef __cplusplus
    } /* extern "C" */
 #endif
@@ -0,0 +1,175 @@
+#include "remotehwinfo-client.hpp"
+#include <stdio.h>
+#include <string.h>
+
+const size_t INITIAL_RESPONSE_CAPACITY = 16 * 1024;
+
+static bool reserveHTTPResponse(struct HTTPResponse *response, size_t capacity) {
+    if (capacity <= response->capacity)
+        return true;
+    size_t newCapacity = response->capacity ? response->capacity : INITIAL_RESPONSE_CAPACITY;
+    while (newCapacity < capacity)
+        newCapacity *= 2;
+    void *largerBuffer = realloc(response->buffer, newCapacity);
+    if (largerBuffer == NULL)
+        return false;
+    response->buffer = (char *)largerBuffer;
+    response->capacity = newCapacity;
+    return true;
+}
+
+static void feedStream(struct HTTPResponse *response, const char *contents, size_t size) {
+    if (response->stream != NULL)
+        json_stream_feed(response->stream, contents, size);
+}
+
+/*
+The new body overwrites the previous one in place. While it is byte-identical to the previous
+body nothing is fed to the parser; at the first difference the parser catches up from the buffer
+and streams normally from then on. A body that turns out identical is never parsed at all.
+*/
+size_t writeCallback(char *contents, size_t chunkSize, size_t chunksCount,
+                     void *writeDestination) {
+    size_t totalSize = chunkSize * chunksCount;
+    struct HTTPResponse *response = (struct HTTPResponse *)writeDestination;
+
+    if (!reserveHTTPResponse(response, response->size + totalSize + 1)) {
+        printf("ERROR: could not allocate enough memory for remotehwinfo response");
+        return 0;
+    }
+
+    if (response->matchesPrevious) {
+        if (response->size + totalSize <= response->previousSize &&
+            memcmp(&(response->buffer[response->size]), contents, totalSize) == 0) {
+            response->size += totalSize;
+            return totalSize;
+        }
+        response->matchesPrevious = false;
+        feedStream(response, response->buffer, response->size);
+    }
+
+    memcpy(&(response->buffer[response->size]), contents, totalSize);
+    response->size += totalSize;
+    feedStream(response, contents, totalSize);
+
+    return totalSize;
+}
+
+// Empties the response but keeps its buffer, so a body the size of the last one fits without
+// reallocating. The buffer contents are left alone to compare the next body against.
+void resetHTTPResponse(struct HTTPResponse *response) {
+    response->size = 0;
+    response->matchesPrevious = response->previousSize > 0;
+    response->unchanged = false;
+    response->transferSize = 0;
+    response->code = CURLE_OK;
+    response->error[0] = '\0';
+    if (response->stream != NULL)
+        json_stream_reset(response->stream);
+}
+
+// Called once the whole body has arrived.
+static void completeHTTPResponse(struct HTTPResponse *response) {
+    if (response->code != CURLE_OK) {
+        response->previousSize = 0;
+        return;
+    }
+    response->unchanged = response->matchesPrevious && response->size == response->previousSize;
+    if (response->matchesPrevious && !response->unchanged)
+        feedStream(response, response->buffer, response->size);
+    response->matchesPrevious = false;
+    response->previousSize = response->size;
+    response->buffer[response->size] = '\0';
+}
+
+void rejectHTTPResponse(struct HTTPResponse *response) {
+    response->previousSize = 0;
+}
+
+void freeHTTPResponse(struct HTTPResponse *response) {
+    free(response->buffer);
+    response->buffer = NULL;
+    response->size = 0;
+    response->capacity = 0;
+    response->previousSize = 0;
+}
+
+bool remoteHwinfoClientInit(struct RemoteHwinfoClient *client, const char *host, uint16_t port) {
+    memset(client, 0, sizeof(*client));
+    snprintf(client->url, sizeof(client->url), "http://%s:%d/json.json", host, port);
+    if (!reserveHTTPResponse(&client->response, INITIAL_RESPONSE_CAPACITY))
+        return false;
+    resetHTTPResponse(&client->response);
+
+    client->curl = curl_easy_init();
+    if (client->curl == NULL) {
+        freeHTTPResponse(&client->response);
+        return false;
+    }
+    CURL *curl = client->curl;
+    curl_easy_setopt(curl, CURLOPT_URL, client->url);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&client->response);
+    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, client->response.error);
+    // An empty string offers every encoding this libcurl can decode (gzip and deflate at least).
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, REMOTEHWINFO_CONNECT_TIMEOUT_MS);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, REMOTEHWINFO_TRANSFER_TIMEOUT_MS);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    return true;
+}
+
+bool remoteHwinfoClientBeginFetch(struct RemoteHwinfoClient *client) {
+    if (client->curl == NULL)
+        return false;
+    resetHTTPResponse(&client->response);
+    return true;
+}
+
+void remoteHwinfoClientEndFetch(struct RemoteHwinfoClient *client, CURLcode result) {
+    struct HTTPResponse *response = &client->response;
+    response->code = result;
+    client->requestCount++;
+
+    long connects = 0;
+    if (curl_easy_getinfo(client->curl, CURLINFO_NUM_CONNECTS, &connects) == CURLE_OK)
+        client->connectCount += connects;
+
+    if (response->code == CURLE_OK) {
+        long status = 0;
+        curl_easy_getinfo(client->curl, CURLINFO_RESPONSE_CODE, &status);
+        if (status != 200) {
+            response->code = CURLE_HTTP_RETURNED_ERROR;
+            snprintf(response->error, sizeof(response->error), "HTTP status %ld from %s",
+                     status, client->url);
+        }
+    }
+    if (response->code != CURLE_OK && strlen(response->error) == 0)
+        snprintf(response->error, sizeof(response->error), "%s",
+                 curl_easy_strerror(response->code));
+    completeHTTPResponse(response);
+    if (response->unchanged)
+        client->unchangedCount++;
+
+    curl_off_t transferSize = 0;
+    if (curl_easy_getinfo(client->curl, CURLINFO_SIZE_DOWNLOAD_T, &transferSize) == CURLE_OK)
+        response->transferSize = transferSize;
+    client->compressedBytes += response->transferSize;
+    client->decompressedBytes += response->size;
+}
+
+bool remoteHwinfoClientFetch(struct RemoteHwinfoClient *client) {
+    if (!remoteHwinfoClientBeginFetch(client))
+        return false;
+    remoteHwinfoClientEndFetch(client, curl_easy_perform(client->curl));
+    return true;
+}
+
+void remoteHwinfoClientCleanup(struct RemoteHwinfoClient *client) {
+    if (client->curl != NULL)
+        curl_easy_cleanup(client->curl);
+    client->curl = NULL;
+    freeHTTPResponse(&client->response);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "json-parser/json.h"
+#include <curl/curl.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+const char REMOTEHWINFO_DEFAULT_HOST[] = "localhost";
+const uint16_t REMOTEHWINFO_DEFAULT_PORT = 27008;
+// A hung or stalled RemoteHWInfo instance is given up on after these and retried on the next
+// poll, instead of waiting for the operating system's TCP timeout.
+const long REMOTEHWINFO_CONNECT_TIMEOUT_MS = 2000;
+const long REMOTEHWINFO_TRANSFER_TIMEOUT_MS = 4000;
+
+struct HTTPResponse {
+    // When set, every chunk is also fed to this parser as it arrives.
+    json_stream *stream;
+    char *buffer;
+    CURLcode code;
+    size_t size;
+    size_t capacity;
+    // Length of the last complete body, which the buffer still holds while a new one arrives;
+    // 0 when there is nothing to compare against or it was rejected.
+    size_t previousSize;
+    // Body bytes as received; less than size when the server compressed the response.
+    curl_off_t transferSize;
+    bool matchesPrevious;
+    bool unchanged;
+    char error[CURL_ERROR_SIZE];
+};
+
+/*
+Long-lived connection to one RemoteHWInfo instance. The curl handle (and with it the TCP
+connection) and the response buffer are kept between polls; curl transparently opens a new
+connection when the server has closed the old one. gzip and deflate responses are decoded by curl
+as they arrive, so writeCallback only ever sees the decompressed body.
+*/
+struct RemoteHwinfoClient {
+    CURL *curl;
+    char url[96 + 1];
+    struct HTTPResponse response;
+    unsigned long requestCount;
+    unsigned long unchangedCount;
+    long connectCount;
+    // Running totals of body bytes before and after content decoding.
+    uint64_t compressedBytes;
+    uint64_t decompressedBytes;
+};
+
+size_t writeCallback(char *contents, size_t chunkSize, size_t chunksCount,
+                     void *writeDestination);
+void resetHTTPResponse(struct HTTPResponse *response);
+// For a body that did not parse: the next one is not compared against it, so that the same bad
+// body again is parsed, and fails, again rather than being taken as unchanged.
+void rejectHTTPResponse(struct HTTPResponse *response);
+void freeHTTPResponse(struct HTTPResponse *response);
+
+bool remoteHwinfoClientInit(struct RemoteHwinfoClient *client, const char *host, uint16_t port);
+bool remoteHwinfoClientFetch(struct RemoteHwinfoClient *client);
+// Split form of remoteHwinfoClientFetch for callers that drive the transfer themselves,
+// e.g. through a curl multi handle.
+bool remoteHwinfoClientBeginFetch(struct RemoteHwinfoClient *client);
+void remoteHwinfoClientEndFetch(struct RemoteHwinfoClient *client, CURLcode result);
+void remoteHwinfoClientCleanup(struct RemoteHwinfoClient *client);
@@ -8,15 +8,16 @@ bool jsonValueHasType(json_value *jsonValue, json_type jsonType)
     return (jsonValue != NULL && jsonValue->type == jsonType);
 }
 
+// Keys looked up once per array element are hashed once, up front.
+static const json_key NAME_KEY = json_key_make("name");
+static const json_key LABEL_ORIGINAL_KEY = json_key_make("labelOriginal");
+static const json_key SENSOR_NAME_ORIGINAL_KEY = json_key_make("sensorNameOriginal");
+static const json_key SENSOR_INDEX_KEY = json_key_make("sensorIndex");
+
+// Compares the hashes json.c recorded for each key before comparing any names.
 json_value *getValueOfKey(json_value *jsonObject, const char *key)
 {
-    json_object_entry *possibleValues = jsonObject->u.object.values;
-    for (int i = 0; i < jsonObject->u.object.length; i++)
-    {
-        if (strcmp(possibleValues[i].name, key) == 0)
-            return possibleValues[i].value;
-    }
-    return NULL;
+    return json_object_find(jsonObject, key);
 }
 
 json_value *getValueOfKeyIfHasType(json_value *jsonObject, const char *key, json_type type)
@@ -27,6 +28,14 @@ json_value *getValueOfKeyIfHasType(json_value *jsonObject, const char *key, json
     return entry;
 }
 
+json_value *getValueOfKeyIfHasType(json_value *jsonObject, const json_key *key, json_type type)
+{
+    json_value *entry = json_object_find_key(jsonObject, key);
+    if (!jsonValueHasType(entry, type))
+        return NULL;
+    return entry;
+}
+
 json_value *getAfterburnerEntries(json_value *afterburner)
 {
     return getValueOfKeyIfHasType(afterburner, "entries", json_array);
@@ -34,7 +43,7 @@ json_value *getAfterburnerEntries(json_value *afterburner)
 
 bool afterburnerEntryHasName(json_value *entry, const char *name)
 {
-    json_value *entryName = getValueOfKeyIfHasType(entry, "name", json_string);
+    json_value *entryName = getValueOfKeyIfHasType(entry, &NAME_KEY, json_string);
     if (entryName == NULL)
         return false;
     return (strcmp(entryName->u.string.ptr, name) == 0);
@@ -56,7 +65,7 @@ json_value *getAfterburnerEntry(json_value *afterburner, const char *name)
 
 bool doesHwinfoEntryHaveName(json_value *entry, const char *name)
 {
-    json_value *entryName = getValueOfKeyIfHasType(entry, "labelOriginal", json_string);
+    json_value *entryName = getValueOfKeyIfHasType(entry, &LABEL_ORIGINAL_KEY, json_string);
     if (entryName == NULL)
         return false;
     return (strcmp(entryName->u.string.ptr, name) == 0);
@@ -64,7 +73,7 @@ bool doesHwinfoEntryHaveName(json_value *entry, const char *name)
 
 bool doesHwinfoGroupHaveName(json_value *group, const char *name)
 {
-    json_value *groupName = getValueOfKeyIfHasType(group, "sensorNameOriginal", json_string);
+    json_value *groupName = getValueOfKeyIfHasType(group, &SENSOR_NAME_ORIGINAL_KEY, json_string);
     if (groupName == NULL)
         return false;
     return (strcmp(groupName->u.string.ptr, name) == 0);
@@ -90,6 +99,7 @@ json_value *getHwinfoEntryValue(json_value *entry)
     return getValueOfKeyIfHasType(entry, "value", json_double);
 }
 
+// A reading's sensorIndex is the entryIndex of its group in hwinfo.sensors.
 bool isHwinfoEntryInGroup(json_value *entry, json_value *group)
 {
     json_value *groupNumber = getValueOfKeyIfHasType(entry, "sensorIndex", json_integer);
@@ -98,7 +108,7 @@ bool isHwinfoEntryInGroup(json_value *entry, json_value *group)
     json_value *entryGroupNumber = getValueOfKeyIfHasType(group, "entryIndex", json_integer);
     if (entryGroupNumber == NULL)
         return false;
-    return entryGroupNumber->u.integer == entryGroupNumber->u.integer;
+    return groupNumber->u.integer == entryGroupNumber->u.integer;
 }
 
 json_value *getHwinfoEntryByName(json_value *hwinfoEntries, const char *name)
@@ -135,7 +145,7 @@ json_value *getHwinfoEntryByNameInGroup(json_value *hwinfo, const char *entryNam
     if (hwinfoGroups == NULL)
         return NULL;
     json_value *entry = getHwinfoEntryByName(hwinfoEntries, entryName);
-    json_value *group = getHwinfoGroup(hwinfoGroups, groupName);
+    json_value *group = getHwinfoGroup(hwinfo, groupName);
     if (isHwinfoEntryInGroup(entry, group))
         return entry;
     return NULL;
@@ -160,7 +170,9 @@ json_value *getHwinfoEntryInGroup(json_value *hwinfo, const char *entryName, jso
     for (int i = 0; i < entries->u.array.length; i++)
     {
         json_value *entry = entries->u.array.values[i];
-        if (doesHwinfoEntryHaveName(entry, entryName))
+        json_value *entryGroupIndex = getValueOfKeyIfHasType(entry, "sensorIndex", json_integer);
+        if (entryGroupIndex != NULL && entryGroupIndex->u.integer == groupIndex &&
+            doesHwinfoEntryHaveName(entry, entryName))
             return entry;
     }
     return NULL;
@@ -197,3 +209,552 @@ double whicheverIsLower(double n1, double n2)
         return n2;
     return n1;
 }
+
+/*
+The same lookups over a json_tape, where a value is the index of its first word and a missing one
+is json_tape_none. Reading objects sit next to each other on the tape, so scanning the readings
+array walks memory front to back instead of chasing a pointer per value.
+*/
+
+bool jsonValueHasType(const json_tape *tape, size_t jsonValue, json_type jsonType)
+{
+    return (tape != NULL && json_tape_type(tape, jsonValue) == jsonType);
+}
+
+size_t getValueOfKey(const json_tape *tape, size_t jsonObject, const char *key)
+{
+    return json_tape_find(tape, jsonObject, key);
+}
+
+size_t getValueOfKeyIfHasType(const json_tape *tape, size_t jsonObject, const char *key, json_type type)
+{
+    size_t entry = getValueOfKey(tape, jsonObject, key);
+    if (!jsonValueHasType(tape, entry, type))
+        return json_tape_none;
+    return entry;
+}
+
+bool isHwinfoEntryInGroup(const json_tape *tape, size_t entry, json_int_t groupNumber)
+{
+    size_t entryGroupNumber = json_tape_find_key(tape, entry, &SENSOR_INDEX_KEY);
+    return (json_tape_type(tape, entryGroupNumber) == json_integer &&
+            json_tape_integer(tape, entryGroupNumber) == groupNumber);
+}
+
+// The tape knows every string's length, so most mismatches never touch the string itself.
+bool tapeStringEquals(const json_tape *tape, size_t jsonString, const char *text, size_t textLength)
+{
+    unsigned int length;
+    const char *string = json_tape_string(tape, jsonString, &length);
+    if (string == NULL || length != textLength)
+        return false;
+    return (memcmp(string, text, textLength) == 0);
+}
+
+size_t getAfterburnerEntry(const json_tape *tape, size_t afterburner, const char *name)
+{
+    size_t afterburnerEntries = getValueOfKeyIfHasType(tape, afterburner, "entries", json_array);
+    size_t nameLength = strlen(name);
+    for (size_t entry = json_tape_first(tape, afterburnerEntries); entry != json_tape_none;
+         entry = json_tape_next(tape, entry))
+    {
+        if (tapeStringEquals(tape, json_tape_find_key(tape, entry, &NAME_KEY), name, nameLength))
+            return entry;
+    }
+    return json_tape_none;
+}
+
+size_t getHwinfoGroup(const json_tape *tape, size_t hwinfo, const char *name)
+{
+    size_t groups = getValueOfKeyIfHasType(tape, hwinfo, "sensors", json_array);
+    size_t nameLength = strlen(name);
+    for (size_t group = json_tape_first(tape, groups); group != json_tape_none;
+         group = json_tape_next(tape, group))
+    {
+        if (tapeStringEquals(tape, json_tape_find_key(tape, group, &SENSOR_NAME_ORIGINAL_KEY),
+                             name, nameLength))
+            return group;
+    }
+    return json_tape_none;
+}
+
+size_t getHwinfoEntryInGroup(const json_tape *tape, size_t hwinfo, const char *entryName,
+                             size_t group)
+{
+    size_t entries = getValueOfKeyIfHasType(tape, hwinfo, "readings", json_array);
+    size_t groupIndex = getValueOfKeyIfHasType(tape, group, "entryIndex", json_integer);
+    if (groupIndex == json_tape_none)
+        return json_tape_none;
+    json_int_t groupNumber = json_tape_integer(tape, groupIndex);
+    size_t entryNameLength = strlen(entryName);
+    for (size_t entry = json_tape_first(tape, entries); entry != json_tape_none;
+         entry = json_tape_next(tape, entry))
+    {
+        if (tapeStringEquals(tape, json_tape_find_key(tape, entry, &LABEL_ORIGINAL_KEY),
+                             entryName, entryNameLength) &&
+            isHwinfoEntryInGroup(tape, entry, groupNumber))
+            return entry;
+    }
+    return json_tape_none;
+}
+
+double getAfterburnerSensorValue(const json_tape *tape, size_t afterburner, const char *name)
+{
+    size_t entry = getAfterburnerEntry(tape, afterburner, name);
+    size_t value = getValueOfKeyIfHasType(tape, entry, "data", json_double);
+    if (value == json_tape_none)
+        return 0;
+    return json_tape_double(tape, value);
+}
+
+double getHwinfoSensorValue(const json_tape *tape, size_t hwinfo, const char *entryName,
+                            const char *groupName)
+{
+    size_t group = getHwinfoGroup(tape, hwinfo, groupName);
+    if (group == json_tape_none)
+        return 0;
+    size_t entry = getHwinfoEntryInGroup(tape, hwinfo, entryName, group);
+    size_t value = getValueOfKeyIfHasType(tape, entry, "value", json_double);
+    if (value == json_tape_none)
+        return 0;
+    return json_tape_double(tape, value);
+}
+
+static const json_key DATA_KEY = json_key_make("data");
+static const json_key VALUE_KEY = json_key_make("value");
+static const json_key ENTRY_INDEX_KEY = json_key_make("entryIndex");
+
+// Hash tables are kept at most half full.
+unsigned int hwinfoTableMask(unsigned int count)
+{
+    unsigned int size = 8;
+    while (size < count * 2)
+        size *= 2;
+    return size - 1;
+}
+
+unsigned int hwinfoReadingHash(const json_key *label, unsigned int group)
+{
+    return label->hash ^ (group * 0x9E3779B1u);
+}
+
+void insertHwinfoSlot(struct HwinfoSlot *slots, unsigned int mask, unsigned int hash,
+                      unsigned int position)
+{
+    unsigned int slot = hash & mask;
+    while (slots[slot].position != 0)
+        slot = (slot + 1) & mask;
+    slots[slot].hash = hash;
+    slots[slot].position = position + 1;
+}
+
+struct HwinfoIndex *buildHwinfoIndex(const json_tape *tape, json_arena *arena)
+{
+    size_t hwinfo = getValueOfKeyIfHasType(tape, 0, "hwinfo", json_object);
+    size_t groups = getValueOfKeyIfHasType(tape, hwinfo, "sensors", json_array);
+    size_t readings = getValueOfKeyIfHasType(tape, hwinfo, "readings", json_array);
+    if (groups == json_tape_none || readings == json_tape_none)
+        return NULL;
+    unsigned int groupCount = json_tape_length(tape, groups);
+    unsigned int readingCount = json_tape_length(tape, readings);
+
+    struct HwinfoIndex *index =
+        (struct HwinfoIndex *)json_arena_alloc(sizeof(struct HwinfoIndex), 0, arena);
+    if (index == NULL)
+        return NULL;
+    index->tape = tape;
+    index->groupMask = hwinfoTableMask(groupCount);
+    index->readingMask = hwinfoTableMask(readingCount);
+    index->groups = (struct HwinfoGroup *)json_arena_alloc(
+        groupCount * sizeof(struct HwinfoGroup) + 1, 0, arena);
+    index->readings = (size_t *)json_arena_alloc(readingCount * sizeof(size_t) + 1, 0, arena);
+    index->labels = (size_t *)json_arena_alloc(readingCount * sizeof(size_t) + 1, 0, arena);
+    index->groupSlots = (struct HwinfoSlot *)json_arena_alloc(
+        (index->groupMask + 1) * sizeof(struct HwinfoSlot), 1, arena);
+    index->readingSlots = (struct HwinfoSlot *)json_arena_alloc(
+        (index->readingMask + 1) * sizeof(struct HwinfoSlot), 1, arena);
+    // Every reading, and the group it belongs to (groupCount for none), in document order
+    size_t *unsorted = (size_t *)json_arena_alloc(readingCount * sizeof(size_t) + 1, 0, arena);
+    unsigned int *readingGroups =
+        (unsigned int *)json_arena_alloc(readingCount * sizeof(unsigned int) + 1, 0, arena);
+    if (index->groups == NULL || index->readings == NULL || index->labels == NULL ||
+        index->groupSlots == NULL || index->readingSlots == NULL || unsorted == NULL ||
+        readingGroups == NULL)
+        return NULL;
+
+    // Groups without an entryIndex cannot have readings, and are left out.
+    index->groupCount = 0;
+    for (size_t group = json_tape_first(tape, groups);
+         group != json_tape_none && index->groupCount < groupCount;
+         group = json_tape_next(tape, group))
+    {
+        size_t number = json_tape_find_key(tape, group, &ENTRY_INDEX_KEY);
+        if (json_tape_type(tape, number) != json_integer)
+            continue;
+        struct HwinfoGroup *entry = &index->groups[index->groupCount];
+        entry->name = json_tape_find_key(tape, group, &SENSOR_NAME_ORIGINAL_KEY);
+        entry->number = json_tape_integer(tape, number);
+        entry->first = 0;
+        entry->count = 0;
+        const char *name = json_tape_string(tape, entry->name, NULL);
+        if (name != NULL)
+        {
+            json_key key = json_key_make(name);
+            insertHwinfoSlot(index->groupSlots, index->groupMask, key.hash, index->groupCount);
+        }
+        index->groupCount++;
+    }
+
+    unsigned int count = 0;
+    for (size_t reading = json_tape_first(tape, readings);
+         reading != json_tape_none && count < readingCount;
+         reading = json_tape_next(tape, reading))
+    {
+        size_t number = json_tape_find_key(tape, reading, &SENSOR_INDEX_KEY);
+        const struct HwinfoGroup *group = NULL;
+        if (json_tape_type(tape, number) == json_integer)
+            group = findHwinfoGroupByNumber(index, json_tape_integer(tape, number));
+        unsorted[count] = reading;
+        readingGroups[count] = group == NULL ? index->groupCount : group - index->groups;
+        if (group != NULL)
+            index->groups[readingGroups[count]].count++;
+        count++;
+    }
+
+    unsigned int first = 0;
+    for (unsigned int i = 0; i < index->groupCount; i++)
+    {
+        index->groups[i].first = first;
+        first += index->groups[i].count;
+        index->groups[i].count = 0;
+    }
+    index->readingCount = first;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (readingGroups[i] == index->groupCount)
+            continue;
+        struct HwinfoGroup *group = &index->groups[readingGroups[i]];
+        unsigned int position = group->first + group->count++;
+        index->readings[position] = unsorted[i];
+        index->labels[position] = json_tape_find_key(tape, unsorted[i], &LABEL_ORIGINAL_KEY);
+        const char *label = json_tape_string(tape, index->labels[position], NULL);
+        if (label == NULL)
+            continue;
+        json_key key = json_key_make(label);
+        insertHwinfoSlot(index->readingSlots, index->readingMask,
+                         hwinfoReadingHash(&key, readingGroups[i]), position);
+    }
+    return index;
+}
+
+const struct HwinfoGroup *findHwinfoGroup(const struct HwinfoIndex *index, const json_key *name)
+{
+    for (unsigned int slot = name->hash & index->groupMask; index->groupSlots[slot].position != 0;
+         slot = (slot + 1) & index->groupMask)
+    {
+        const struct HwinfoGroup *group = &index->groups[index->groupSlots[slot].position - 1];
+        if (index->groupSlots[slot].hash == name->hash &&
+            tapeStringEquals(index->tape, group->name, name->name, name->length))
+            return group;
+    }
+    return NULL;
+}
+
+// Groups are numbered in order from 0, as a rule, so the group numbered n is usually the nth.
+const struct HwinfoGroup *findHwinfoGroupByNumber(const struct HwinfoIndex *index,
+                                                  json_int_t number)
+{
+    if (number >= 0 && number < index->groupCount && index->groups[number].number == number)
+        return &index->groups[number];
+    for (unsigned int i = 0; i < index->groupCount; i++)
+    {
+        if (index->groups[i].number == number)
+            return &index->groups[i];
+    }
+    return NULL;
+}
+
+int findHwinfoReading(const struct HwinfoIndex *index, const struct HwinfoGroup *group,
+                      const json_key *label)
+{
+    unsigned int hash = hwinfoReadingHash(label, group - index->groups);
+    for (unsigned int slot = hash & index->readingMask; index->readingSlots[slot].position != 0;
+         slot = (slot + 1) & index->readingMask)
+    {
+        unsigned int position = index->readingSlots[slot].position - 1;
+        if (index->readingSlots[slot].hash == hash && position - group->first < group->count &&
+            tapeStringEquals(index->tape, index->labels[position], label->name, label->length))
+            return (int)position;
+    }
+    return -1;
+}
+
+void initSensorHandles(struct SensorHandle *handles, const struct SensorTableView *table)
+{
+    for (unsigned int i = 0; i < table->count; i++)
+    {
+        memset(&handles[i], 0, sizeof(handles[i]));
+        handles[i].sensor = &table->sensors[i];
+        handles[i].label = json_tape_none;
+        handles[i].value = json_tape_none;
+        handles[i].entry = json_tape_none;
+    }
+}
+
+// The name and data must still be of the one entry, as a layout change can move either.
+bool isAfterburnerSensorHandleValid(const json_tape *tape, const struct SensorHandle *handle)
+{
+    if (json_tape_type(tape, handle->entry) != json_object)
+        return false;
+    size_t end = json_tape_skip(tape, handle->entry);
+    return handle->label > handle->entry && handle->label < end &&
+           handle->value > handle->entry && handle->value < end;
+}
+
+// The group's reading must be the one remembered, as a label can be in several groups.
+bool isHwinfoSensorHandleValid(const json_tape *tape, const struct HwinfoIndex *index,
+                               const struct SensorHandle *handle)
+{
+    if (index == NULL || handle->group >= index->groupCount)
+        return false;
+    const struct HwinfoGroup *group = &index->groups[handle->group];
+    if (handle->reading - group->first >= group->count ||
+        index->labels[handle->reading] != handle->label)
+        return false;
+    size_t reading = index->readings[handle->reading];
+    const json_key *groupName = &handle->sensor->group;
+    return handle->value > reading && handle->value < json_tape_skip(tape, reading) &&
+           tapeStringEquals(tape, group->name, groupName->name, groupName->length);
+}
+
+bool isSensorHandleValid(const json_tape *tape, const struct HwinfoIndex *index,
+                         const struct SensorHandle *handle)
+{
+    const SensorDescriptor *sensor = handle->sensor;
+    bool afterburner = sensor->source == AFTERBURNER_SENSOR;
+    const json_key *nameKey = afterburner ? &NAME_KEY : &LABEL_ORIGINAL_KEY;
+    const json_key *valueKey = afterburner ? &DATA_KEY : &VALUE_KEY;
+    return json_tape_is_member(tape, handle->label, nameKey) &&
+           tapeStringEquals(tape, handle->label, sensor->label.name, sensor->label.length) &&
+           json_tape_is_member(tape, handle->value, valueKey) &&
+           (afterburner ? isAfterburnerSensorHandleValid(tape, handle)
+                        : isHwinfoSensorHandleValid(tape, index, handle));
+}
+
+void resolveHwinfoSensorHandle(const json_tape *tape, const struct HwinfoIndex *index,
+                               struct SensorHandle *handle)
+{
+    const struct HwinfoGroup *group =
+        index == NULL ? NULL : findHwinfoGroup(index, &handle->sensor->group);
+    if (group == NULL)
+        return;
+    int reading = findHwinfoReading(index, group, &handle->sensor->label);
+    if (reading < 0)
+        return;
+    handle->group = group - index->groups;
+    handle->reading = reading;
+    handle->label = index->labels[reading];
+    handle->value = json_tape_find_key(tape, index->readings[reading], &VALUE_KEY);
+}
+
+// The Afterburner sensor of table named name, or -1.
+int findAfterburnerSensor(const struct SensorTableView *table, const char *name,
+                          unsigned int length)
+{
+    unsigned int hash = sensorHash(sensorNameHash(name, length), 0);
+    int sensor = table->slots[sensorSlot(hash, table->seed, table->bits)] - 1;
+    if (sensor < 0)
+        return -1;
+    const json_key *label = &table->sensors[sensor].label;
+    if (table->sensors[sensor].source != AFTERBURNER_SENSOR || label->length != length ||
+        memcmp(label->name, name, length) != 0)
+        return -1;
+    return sensor;
+}
+
+// Gives every handle that has no label yet the first entry of afterburner.entries named after it.
+void resolveAfterburnerSensorHandles(const json_tape *tape, const struct SensorTableView *table,
+                                     struct SensorHandle *handles, int unresolved)
+{
+    size_t afterburner = getValueOfKeyIfHasType(tape, 0, "afterburner", json_object);
+    size_t entries = getValueOfKeyIfHasType(tape, afterburner, "entries", json_array);
+    for (size_t entry = json_tape_first(tape, entries);
+         entry != json_tape_none && unresolved > 0; entry = json_tape_next(tape, entry))
+    {
+        size_t label = json_tape_find_key(tape, entry, &NAME_KEY);
+        unsigned int length;
+        const char *name = json_tape_string(tape, label, &length);
+        int sensor = name == NULL ? -1 : findAfterburnerSensor(table, name, length);
+        if (sensor < 0 || handles[sensor].label != json_tape_none)
+            continue;
+        handles[sensor].label = label;
+        handles[sensor].value = json_tape_find_key(tape, entry, &DATA_KEY);
+        handles[sensor].entry = entry;
+        unresolved--;
+    }
+}
+
+static void resolveSensorHandles(const json_tape *tape, const struct HwinfoIndex *hwinfoIndex,
+                                 const struct SensorTableView *table,
+                                 struct SensorHandle *handles)
+{
+    int unresolved = 0;
+    for (unsigned int i = 0; tape != NULL && i < table->count; i++)
+    {
+        struct SensorHandle *handle = &handles[i];
+        if (isSensorHandleValid(tape, hwinfoIndex, handle))
+        {
+            handle->hits++;
+            continue;
+        }
+        handle->misses++;
+        handle->label = json_tape_none;
+        handle->value = json_tape_none;
+        handle->entry = json_tape_none;
+        if (handle->sensor->source == AFTERBURNER_SENSOR)
+            unresolved++;
+        else
+            resolveHwinfoSensorHandle(tape, hwinfoIndex, handle);
+    }
+    if (unresolved > 0)
+        resolveAfterburnerSensorHandles(tape, table, handles, unresolved);
+}
+
+void getSensorValues(const json_tape *tape, const struct HwinfoIndex *hwinfoIndex,
+                     const struct SensorTableView *table, struct SensorHandle *handles,
+                     double *values)
+{
+    resolveSensorHandles(tape, hwinfoIndex, table, handles);
+    for (unsigned int i = 0; i < table->count; i++)
+    {
+        values[i] = 0;
+        if (jsonValueHasType(tape, handles[i].value, json_double))
+            values[i] = json_tape_double(tape, handles[i].value);
+    }
+}
+
+void getSensorSnapshot(const json_tape *tape, const struct HwinfoIndex *hwinfoIndex,
+                       const struct SensorTableView *table, struct SensorHandle *handles,
+                       struct SensorSnapshot *snapshot)
+{
+    snapshot->object = jsonValueHasType(tape, 0, json_object);
+    snapshot->sources = 0;
+    if (getValueOfKeyIfHasType(tape, 0, "afterburner", json_object) != json_tape_none)
+        snapshot->sources |= 1u << AFTERBURNER_SENSOR;
+    if (getValueOfKeyIfHasType(tape, 0, "hwinfo", json_object) != json_tape_none)
+        snapshot->sources |= 1u << HWINFO_SENSOR;
+    snapshot->count = table->count;
+    if (snapshot->count > SENSOR_SNAPSHOT_CAPACITY)
+        snapshot->count = SENSOR_SNAPSHOT_CAPACITY;
+    snapshot->valid = 0;
+    resolveSensorHandles(tape, hwinfoIndex, table, handles);
+    for (unsigned int i = 0; i < snapshot->count; i++)
+    {
+        snapshot->values[i] = 0;
+        if (!jsonValueHasType(tape, handles[i].value, json_double))
+            continue;
+        double value = json_tape_double(tape, handles[i].value);
+        if (value != value)
+            continue;
+        snapshot->values[i] = sensorSnapshotFixed(value);
+        snapshot->valid |= (uint32_t)1 << i;
+    }
+}
+
+/*
+The same lookups straight from the response text, with no document built at all: a value is its
+offset in the text and a missing one is json_text_none. Readings that are not wanted are stepped
+over bracket by bracket, so a lookup needs no memory beyond the text however many readings there
+are, but it does read through them again on every call.
+*/
+
+bool jsonValueHasType(const json_text *text, size_t jsonValue, json_type jsonType)
+{
+    return (text != NULL && json_text_type(text, jsonValue) == jsonType);
+}
+
+size_t getValueOfKey(const json_text *text, size_t jsonObject, const char *key)
+{
+    return json_text_find(text, jsonObject, key);
+}
+
+size_t getValueOfKeyIfHasType(const json_text *text, size_t jsonObject, const char *key, json_type type)
+{
+    size_t entry = getValueOfKey(text, jsonObject, key);
+    if (!jsonValueHasType(text, entry, type))
+        return json_text_none;
+    return entry;
+}
+
+size_t getAfterburnerEntry(const json_text *text, size_t afterburner, const char *name)
+{
+    size_t afterburnerEntries = getValueOfKeyIfHasType(text, afterburner, "entries", json_array);
+    size_t nameLength = strlen(name);
+    for (size_t entry = json_text_first(text, afterburnerEntries); entry != json_text_none;
+         entry = json_text_next(text, entry))
+    {
+        if (json_text_string_equals(text, json_text_find_key(text, entry, &NAME_KEY), name,
+                                    nameLength))
+            return entry;
+    }
+    return json_text_none;
+}
+
+size_t getHwinfoGroup(const json_text *text, size_t hwinfo, const char *name)
+{
+    size_t groups = getValueOfKeyIfHasType(text, hwinfo, "sensors", json_array);
+    size_t nameLength = strlen(name);
+    for (size_t group = json_text_first(text, groups); group != json_text_none;
+         group = json_text_next(text, group))
+    {
+        if (json_text_string_equals(text, json_text_find_key(text, group, &SENSOR_NAME_ORIGINAL_KEY),
+                                    name, nameLength))
+            return group;
+    }
+    return json_text_none;
+}
+
+size_t getHwinfoEntryInGroup(const json_text *text, size_t hwinfo, const char *entryName,
+                             size_t group)
+{
+    size_t entries = getValueOfKeyIfHasType(text, hwinfo, "readings", json_array);
+    size_t groupIndex = getValueOfKeyIfHasType(text, group, "entryIndex", json_integer);
+    if (groupIndex == json_text_none)
+        return json_text_none;
+    json_int_t groupNumber = json_text_integer(text, groupIndex);
+    size_t entryNameLength = strlen(entryName);
+    for (size_t entry = json_text_first(text, entries); entry != json_text_none;
+         entry = json_text_next(text, entry))
+    {
+        if (!json_text_string_equals(text, json_text_find_key(text, entry, &LABEL_ORIGINAL_KEY),
+                                     entryName, entryNameLength))
+            continue;
+        size_t entryGroupNumber = json_text_find_key(text, entry, &SENSOR_INDEX_KEY);
+        if (json_text_type(text, entryGroupNumber) == json_integer &&
+            json_text_integer(text, entryGroupNumber) == groupNumber)
+            return entry;
+    }
+    return json_text_none;
+}
+
+double getAfterburnerSensorValue(const json_text *text, size_t afterburner, const char *name)
+{
+    size_t entry = getAfterburnerEntry(text, afterburner, name);
+    size_t value = getValueOfKeyIfHasType(text, entry, "data", json_double);
+    if (value == json_text_none)
+        return 0;
+    return json_text_double(text, value);
+}
+
+double getHwinfoSensorValue(const json_text *text, size_t hwinfo, const char *entryName,
+                            const char *groupName)
+{
+    size_t group = getHwinfoGroup(text, hwinfo, groupName);
+    if (group == json_text_none)
+        return 0;
+    size_t entry = getHwinfoEntryInGroup(text, hwinfo, entryName, group);
+    size_t value = getValueOfKeyIfHasType(text, entry, "value", json_double);
+    if (value == json_text_none)
+        return 0;
+    return json_text_double(text, value);
+}
@@ -1,5 +1,8 @@
+#pragma once
 #include "json-parser/json.h"
 #include "json-parser/json.h"
+#include "sensor-snapshot.hpp"
+#include "sensor-table.hpp"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -8,4 +11,99 @@ double getAfterburnerSensorValue(json_value *afterburner, const char *name);
 bool jsonValueHasType(json_value *jsonValue, json_type jsonType);
 double whicheverIsLower(double n1, double n2);
 json_value *getValueOfKey(json_value *jsonObject, const char *key);
-json_value *getValueOfKeyIfHasType(json_value *jsonObject, const char *key, json_type type);
\ No newline at end of file
+json_value *getValueOfKeyIfHasType(json_value *jsonObject, const char *key, json_type type);
+json_value *getValueOfKeyIfHasType(json_value *jsonObject, const json_key *key, json_type type);
+
+// The same lookups over a json_tape; values are word indexes, json_tape_none when missing.
+double getHwinfoSensorValue(const json_tape *tape, size_t hwinfo, const char *entryName,
+                            const char *groupName);
+double getAfterburnerSensorValue(const json_tape *tape, size_t afterburner, const char *name);
+bool jsonValueHasType(const json_tape *tape, size_t jsonValue, json_type jsonType);
+size_t getValueOfKey(const json_tape *tape, size_t jsonObject, const char *key);
+size_t getValueOfKeyIfHasType(const json_tape *tape, size_t jsonObject, const char *key,
+                              json_type type);
+
+/*
+hwinfo.readings indexed by group, built once per tape. The readings of every hwinfo.sensors group
+are gathered into one run of readings, in document order, by their sensorIndex (the entryIndex
+of their group), and a table of (group, label) hashes finds a reading of a given group in a probe
+or two. A label is found in the right group however many groups share it, as every network
+adapter has a "Current UP rate".
+*/
+struct HwinfoGroup {
+    size_t name;        // its sensorNameOriginal string
+    json_int_t number;  // its entryIndex
+    unsigned int first; // its readings are readings[first] to readings[first + count - 1]
+    unsigned int count;
+};
+
+struct HwinfoSlot {
+    unsigned int hash;
+    unsigned int position; // in groups or readings, plus one; 0 for an empty slot
+};
+
+struct HwinfoIndex {
+    const json_tape *tape;
+    struct HwinfoGroup *groups;
+    unsigned int groupCount;
+    size_t *readings;       // the reading objects, group by group
+    size_t *labels;         // and their labelOriginal strings
+    unsigned int readingCount;
+    struct HwinfoSlot *groupSlots; // by group name
+    unsigned int groupMask;
+    struct HwinfoSlot *readingSlots; // by group and label
+    unsigned int readingMask;
+};
+
+// Builds the index of the tape's hwinfo in arena, or returns NULL if it has no hwinfo.sensors or
+// hwinfo.readings array (or arena runs out). The index holds word indexes only, so it serves any
+// tape with the same layout, such as one patched by json_fast_reparse, once tape is set to it.
+struct HwinfoIndex *buildHwinfoIndex(const json_tape *tape, json_arena *arena);
+const struct HwinfoGroup *findHwinfoGroup(const struct HwinfoIndex *index, const json_key *name);
+const struct HwinfoGroup *findHwinfoGroupByNumber(const struct HwinfoIndex *index,
+                                                  json_int_t number);
+// The position in index->readings of the first reading of group labelled label, or -1.
+int findHwinfoReading(const struct HwinfoIndex *index, const struct HwinfoGroup *group,
+                      const json_key *label);
+
+/*
+A sensor of a SensorTable looked up by name once and then read by tape index. Each read first
+checks that the name at the remembered index is still the sensor's (a tape from a document of the
+same layout, which is every poll while the set of sensors does not change, keeps its indexes), and
+only when it is not looks the sensor up again. HWiNFO sensors are looked up and checked through
+the tape's HwinfoIndex, which also makes sure the reading is still in the sensor's group.
+*/
+struct SensorHandle {
+    const SensorDescriptor *sensor;
+    size_t label;          // the entry's name string on the last tape read, or json_tape_none
+    size_t value;
+    size_t entry;          // Afterburner only: the entry object holding both
+    unsigned int group;    // HWiNFO only: the group and reading position in the HwinfoIndex
+    unsigned int reading;
+    unsigned long hits;    // reads served from the remembered indexes
+    unsigned long misses;  // reads that had to look the sensor up (the first, for one)
+};
+
+// One handle per sensor of table, in the same order.
+void initSensorHandles(struct SensorHandle *handles, const struct SensorTableView *table);
+// Reads the value of every sensor of table into values. The Afterburner entries that need it are
+// looked up in a single walk over afterburner.entries, each name with one probe of the table.
+// hwinfoIndex is the tape's, or NULL if it has none; HWiNFO sensors then read 0.
+void getSensorValues(const json_tape *tape, const struct HwinfoIndex *hwinfoIndex,
+                     const struct SensorTableView *table, struct SensorHandle *handles,
+                     double *values);
+// The same, into snapshot: every sensor of table that fits, in fixed point, and which of
+// Afterburner and HWiNFO the document has. sequence and receivedAt are left to the caller.
+void getSensorSnapshot(const json_tape *tape, const struct HwinfoIndex *hwinfoIndex,
+                       const struct SensorTableView *table, struct SensorHandle *handles,
+                       struct SensorSnapshot *snapshot);
+
+// The same lookups straight from the document text, with no document built; values are offsets
+// into the text, json_text_none when missing.
+double getHwinfoSensorValue(const json_text *text, size_t hwinfo, const char *entryName,
+                            const char *groupName);
+double getAfterburnerSensorValue(const json_text *text, size_t afterburner, const char *name);
+bool jsonValueHasType(const json_text *text, size_t jsonValue, json_type jsonType);
+size_t getValueOfKey(const json_text *text, size_t jsonObject, const char *key);
+size_t getValueOfKeyIfHasType(const json_text *text, size_t jsonObject, const char *key,
+                              json_type type);
\ No newline at end of file
@@ -0,0 +1,279 @@
+#include "remotehwinfo-poller.hpp"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+static long long steadyNowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+bool remoteHwinfoPollerInit(struct RemoteHwinfoPoller *poller) {
+    poller->sourceCount = 0;
+    poller->multi = curl_multi_init();
+    return poller->multi != NULL;
+}
+
+// The parser allocates straight into the source's arena.
+static void *allocateInSourceArena(size_t size, int zero, void *userData) {
+    struct RemoteHwinfoSource *source = (struct RemoteHwinfoSource *)userData;
+    return json_arena_alloc(size, zero, source->arena);
+}
+
+static void freeSource(struct RemoteHwinfoSource *source) {
+    json_stream_free(source->client.response.stream);
+    source->client.response.stream = NULL;
+    remoteHwinfoClientCleanup(&source->client);
+    json_arena_free(source->arena);
+    json_arena_free(source->indexArena);
+    sensorHistoryFree(&source->history);
+    source->arena = NULL;
+    source->indexArena = NULL;
+    source->hwinfoIndex = NULL;
+}
+
+struct RemoteHwinfoSource *remoteHwinfoPollerAddSource(struct RemoteHwinfoPoller *poller,
+                                                       const char *host, uint16_t port,
+                                                       const struct SensorTableView *sensorTable,
+                                                       const struct SensorHistoryConfig *history,
+                                                       const struct SensorMetricsConfig *metrics) {
+    if (poller->sourceCount == MAX_REMOTEHWINFO_SOURCES ||
+        sensorTable->count + history->queryCount + metrics->count > SENSOR_SNAPSHOT_CAPACITY)
+        return NULL;
+    struct RemoteHwinfoSource *source = &poller->sources[poller->sourceCount];
+    if (!sensorMetricsInit(&source->metrics, metrics))
+        return NULL;
+    source->inFlight = false;
+    source->updated = false;
+    source->failureCount = 0;
+    source->sequence = 0;
+    source->hwinfoIndex = NULL;
+    source->lastParsedCount = 0;
+    source->sensorTable = sensorTable;
+    initSensorHandles(source->handles, sensorTable);
+    for (SensorSnapshot &snapshot : source->snapshots.slots)
+        snapshot = SensorSnapshot{};
+    source->lastResponseMs.store(steadyNowMs());
+    if (!remoteHwinfoClientInit(&source->client, host, port))
+        return NULL;
+    bool created = sensorHistoryInit(&source->history, sensorTable->count, history);
+    source->arena = json_arena_new(0);
+    source->indexArena = json_arena_new(0);
+    created = created && source->arena != NULL && source->indexArena != NULL;
+    // Documents are parsed into tapes whose strings point into the arena's copy of the body.
+    // Only the few readings on screen are ever read, so doubles stay text until then. Between
+    // polls only the numbers change, so a body is patched into the last tape parsed in full
+    // rather than parsed again, unless its layout changed.
+    json_settings settings = {0};
+    settings.settings = json_emit_tape | json_lazy_numbers | json_fast_reparse;
+    settings.mem_alloc = allocateInSourceArena;
+    settings.mem_free = json_arena_release;
+    settings.user_data = source;
+    source->client.response.stream = created ? json_stream_new(&settings) : NULL;
+    if (source->client.response.stream == NULL) {
+        freeSource(source);
+        return NULL;
+    }
+    curl_easy_setopt(source->client.curl, CURLOPT_PRIVATE, (void *)source);
+    poller->sourceCount++;
+    return source;
+}
+
+static void startTransfers(struct RemoteHwinfoPoller *poller) {
+    for (int i = 0; i < poller->sourceCount; i++) {
+        struct RemoteHwinfoSource *source = &poller->sources[i];
+        source->updated = false;
+        if (source->inFlight || !remoteHwinfoClientBeginFetch(&source->client))
+            continue;
+        // The last document has been read into its snapshot, if it parsed, and is not needed.
+        json_arena_reset(source->arena);
+        if (curl_multi_add_handle(poller->multi, source->client.curl) == CURLM_OK)
+            source->inFlight = true;
+    }
+}
+
+// Reads the sensors of the last document into snapshot, as of now, and appends them to the
+// history and metrics, whose queries and values complete it. A poll is one sample, whether its
+// body changed or not, so what the history and metrics count in samples they count in polls.
+static void appendSample(struct RemoteHwinfoSource *source, struct SensorSnapshot *snapshot) {
+    *snapshot = source->sensors;
+    snapshot->receivedAt = std::chrono::steady_clock::now();
+    sensorHistoryAppendSnapshot(&source->history, snapshot);
+    sensorMetricsAppendSnapshot(&source->metrics, snapshot);
+}
+
+static void publishSnapshot(struct RemoteHwinfoSource *source) {
+    SensorSnapshot *snapshot = &source->snapshots.back();
+    appendSample(source, snapshot);
+    snapshot->sequence = ++source->sequence;
+    source->snapshots.publish();
+    source->updated = true;
+}
+
+// The body has been copied chunk by chunk while it was received; finishing the stream compares
+// it with the last document parsed in full and patches or parses it.
+static void parseSnapshot(struct RemoteHwinfoSource *source) {
+    struct HTTPResponse *response = &source->client.response;
+    if (response->code != CURLE_OK) {
+        source->failureCount++;
+        json_stream_reset(response->stream);
+        fprintf(stderr, "ERROR: %s\n", response->error);
+        return;
+    }
+    // An unchanged body is still a sample, but not a new snapshot: the display has shown its
+    // sensors already and is spared rendering and sending them again.
+    if (response->unchanged) {
+        struct SensorSnapshot repeated;
+        if (source->sequence > 0)
+            appendSample(source, &repeated);
+        source->lastResponseMs.store(steadyNowMs());
+        return;
+    }
+    char error[json_error_max];
+    json_tape *document = json_stream_finish_tape(response->stream, error);
+    if (document == NULL) {
+        source->failureCount++;
+        rejectHTTPResponse(response);
+        fprintf(stderr, "ERROR: Failed to parse JSON response from %s: %s\n",
+                source->client.url, error);
+        return;
+    }
+    // Readings are indexed by group here, off the display thread, once per layout.
+    unsigned long patched, parsed;
+    json_stream_reparse_counts(response->stream, &patched, &parsed);
+    if (source->hwinfoIndex != NULL && parsed > 0 && parsed == source->lastParsedCount) {
+        source->hwinfoIndex->tape = document;
+    } else {
+        json_arena_reset(source->indexArena);
+        source->hwinfoIndex = buildHwinfoIndex(document, source->indexArena);
+    }
+    source->lastParsedCount = parsed;
+    getSensorSnapshot(document, source->hwinfoIndex, source->sensorTable, source->handles,
+                      &source->sensors);
+    publishSnapshot(source);
+    source->lastResponseMs.store(steadyNowMs());
+}
+
+bool remoteHwinfoSourceAcquire(struct RemoteHwinfoSource *source) {
+    return source->snapshots.acquire();
+}
+
+size_t remoteHwinfoSourceArenaHighWater(const struct RemoteHwinfoSource *source) {
+    return json_arena_high_water(source->arena);
+}
+
+void remoteHwinfoSourceParseCounts(const struct RemoteHwinfoSource *source,
+                                   unsigned long *patched, unsigned long *parsed) {
+    json_stream_reparse_counts(source->client.response.stream, patched, parsed);
+}
+
+void remoteHwinfoSourceSensorCounts(const struct RemoteHwinfoSource *source, unsigned long *hits,
+                                    unsigned long *misses) {
+    *hits = 0;
+    *misses = 0;
+    for (unsigned int i = 0; i < source->sensorTable->count; i++) {
+        *hits += source->handles[i].hits;
+        *misses += source->handles[i].misses;
+    }
+}
+
+long long remoteHwinfoSourceSilenceMs(const struct RemoteHwinfoSource *source) {
+    return steadyNowMs() - source->lastResponseMs.load();
+}
+
+static int finishTransfers(struct RemoteHwinfoPoller *poller) {
+    int finished = 0;
+    int messagesLeft;
+    CURLMsg *message;
+    while ((message = curl_multi_info_read(poller->multi, &messagesLeft)) != NULL) {
+        if (message->msg != CURLMSG_DONE)
+            continue;
+        struct RemoteHwinfoSource *source = NULL;
+        curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, (char **)&source);
+        CURLcode result = message->data.result;
+        curl_multi_remove_handle(poller->multi, message->easy_handle);
+        source->inFlight = false;
+        remoteHwinfoClientEndFetch(&source->client, result);
+        parseSnapshot(source);
+        finished++;
+    }
+    return finished;
+}
+
+static int countInFlight(struct RemoteHwinfoPoller *poller) {
+    int inFlight = 0;
+    for (int i = 0; i < poller->sourceCount; i++)
+        inFlight += poller->sources[i].inFlight;
+    return inFlight;
+}
+
+// Starts a transfer for every idle source and drives all transfers until each has finished or
+// timeoutMs has passed. Returns the number of sources with a fresh snapshot.
+int remoteHwinfoPollerPoll(struct RemoteHwinfoPoller *poller, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    startTransfers(poller);
+
+    int running = 0;
+    curl_multi_perform(poller->multi, &running);
+    finishTransfers(poller);
+    while (countInFlight(poller) > 0) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0)
+            break;
+        curl_multi_poll(poller->multi, NULL, 0, (int)remaining.count(), NULL);
+        curl_multi_perform(poller->multi, &running);
+        finishTransfers(poller);
+    }
+
+    int updated = 0;
+    for (int i = 0; i < poller->sourceCount; i++)
+        updated += poller->sources[i].updated;
+    return updated;
+}
+
+// Nothing is in flight while waiting for the next tick, so the only thing that ends the wait
+// early is curl_multi_wakeup from remoteHwinfoPollerStop.
+static void runPoller(struct RemoteHwinfoPoller *poller, int intervalMs) {
+    while (poller->running.load()) {
+        auto next = std::chrono::steady_clock::now() + std::chrono::milliseconds(intervalMs);
+        remoteHwinfoPollerPoll(poller, intervalMs);
+        while (poller->running.load()) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                next - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0)
+                break;
+            curl_multi_poll(poller->multi, NULL, 0, (int)remaining.count(), NULL);
+        }
+    }
+}
+
+// Polls every intervalMs on a background thread until remoteHwinfoPollerStop.
+bool remoteHwinfoPollerStart(struct RemoteHwinfoPoller *poller, int intervalMs) {
+    if (poller->running.exchange(true))
+        return false;
+    poller->thread = std::thread(runPoller, poller, intervalMs);
+    return true;
+}
+
+void remoteHwinfoPollerStop(struct RemoteHwinfoPoller *poller) {
+    if (!poller->running.exchange(false))
+        return;
+    curl_multi_wakeup(poller->multi);
+    poller->thread.join();
+}
+
+void remoteHwinfoPollerCleanup(struct RemoteHwinfoPoller *poller) {
+    remoteHwinfoPollerStop(poller);
+    for (int i = 0; i < poller->sourceCount; i++) {
+        struct RemoteHwinfoSource *source = &poller->sources[i];
+        if (source->inFlight)
+            curl_multi_remove_handle(poller->multi, source->client.curl);
+        freeSource(source);
+    }
+    poller->sourceCount = 0;
+    if (poller->multi != NULL)
+        curl_multi_cleanup(poller->multi);
+    poller->multi = NULL;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "json-parser/json.h"
+#include "remotehwinfo-client.hpp"
+#include "remotehwinfo-parser.hpp"
+#include "sensor-history.hpp"
+#include "sensor-metrics.hpp"
+#include "sensor-snapshot.hpp"
+#include "triple-buffer.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+const int MAX_REMOTEHWINFO_SOURCES = 16;
+
+/*
+One polled RemoteHWInfo instance. Every document that is fetched and parsed successfully is read
+into a SensorSnapshot of the source's sensor table on the poller thread, appended to its history
+and completed with the history's queries and its derived metrics, and the snapshot is published
+through snapshots; the display thread picks up the newest one with remoteHwinfoSourceAcquire.
+Nothing past the poller thread ever sees a document, so the one being parsed is the only one
+kept: arena is reset for every fetch.
+*/
+struct RemoteHwinfoSource {
+    struct RemoteHwinfoClient client;
+    TripleBuffer<SensorSnapshot> snapshots;
+    bool inFlight = false;
+    bool updated = false;
+    unsigned long failureCount = 0;
+    unsigned long sequence = 0;
+    json_arena *arena = NULL;
+    // The index of the last document parsed in full, and how many documents the stream had
+    // parsed in full then: while that does not change, every document has the same layout and
+    // the index only needs to be pointed at the new tape.
+    json_arena *indexArena = NULL;
+    struct HwinfoIndex *hwinfoIndex = NULL;
+    unsigned long lastParsedCount = 0;
+    const struct SensorTableView *sensorTable = NULL;
+    struct SensorHandle handles[SENSOR_SNAPSHOT_CAPACITY];
+    struct SensorSnapshot sensors; // of the last document parsed, sampled again while unchanged
+    struct SensorHistory history;
+    struct SensorMetrics metrics;
+    // steady_clock time, in milliseconds, of the last good response (changed or not).
+    std::atomic<long long> lastResponseMs{0};
+};
+
+/*
+Polls every source concurrently through one curl multi handle. A source whose transfer has not
+finished yet simply stays in flight across calls to remoteHwinfoPollerPoll, so a slow or dead
+host never holds back the others. remoteHwinfoPollerStart runs the polling on its own thread.
+*/
+struct RemoteHwinfoPoller {
+    CURLM *multi = NULL;
+    struct RemoteHwinfoSource sources[MAX_REMOTEHWINFO_SOURCES];
+    int sourceCount = 0;
+    std::thread thread;
+    std::atomic<bool> running{false};
+};
+
+bool remoteHwinfoPollerInit(struct RemoteHwinfoPoller *poller);
+// sensorTable lists the sensors the source's snapshots hold, history what is kept of them and
+// read back into the snapshots, and metrics what is derived from them after that: all of which
+// must fit in SENSOR_SNAPSHOT_CAPACITY values.
+struct RemoteHwinfoSource *remoteHwinfoPollerAddSource(struct RemoteHwinfoPoller *poller,
+                                                       const char *host, uint16_t port,
+                                                       const struct SensorTableView *sensorTable,
+                                                       const struct SensorHistoryConfig *history,
+                                                       const struct SensorMetricsConfig *metrics);
+int remoteHwinfoPollerPoll(struct RemoteHwinfoPoller *poller, int timeoutMs);
+bool remoteHwinfoPollerStart(struct RemoteHwinfoPoller *poller, int intervalMs);
+void remoteHwinfoPollerStop(struct RemoteHwinfoPoller *poller);
+void remoteHwinfoPollerCleanup(struct RemoteHwinfoPoller *poller);
+
+// Display thread side: returns true when a newer snapshot than the last one acquired was
+// published. The current one is source->snapshots.front(), with sequence 0 until then.
+bool remoteHwinfoSourceAcquire(struct RemoteHwinfoSource *source);
+// Milliseconds since the source last answered with a good response, or since it was added.
+long long remoteHwinfoSourceSilenceMs(const struct RemoteHwinfoSource *source);
+// Largest amount of arena memory one parsed document of this source has needed.
+size_t remoteHwinfoSourceArenaHighWater(const struct RemoteHwinfoSource *source);
+// Documents patched into the last tape because only their numbers changed, and documents parsed
+// in full (the first, and every one whose layout changed).
+void remoteHwinfoSourceParseCounts(const struct RemoteHwinfoSource *source,
+                                   unsigned long *patched, unsigned long *parsed);
+// Sensor reads served from the handles' remembered indexes, and lookups by name, over every
+// sensor. Only once the poller has stopped.
+void remoteHwinfoSourceSensorCounts(const struct RemoteHwinfoSource *source, unsigned long *hits,
+                                    unsigned long *misses);
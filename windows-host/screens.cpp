@@ -1,41 +1,98 @@
 #include "screens.hpp"
-#include "json-parser/json.h"
 #include "remotehwinfo-parser.hpp"
+#include <string.h>
 
 const char DEGREE_SYMBOL = 178;
+constexpr char NETWORK_GROUP[] = "Network: Broadcom 802.11ac Wireless PCIE Full Dongle Adapter";
+
+// In ScreenSensor order.
+constexpr SensorDescriptor SCREEN_SENSORS[] = {
+    afterburnerSensor("GPU temperature"),
+    afterburnerSensor("GPU usage"),
+    afterburnerSensor("Framerate"),
+    afterburnerSensor("CPU temperature"),
+    afterburnerSensor("CPU usage"),
+    afterburnerSensor("Fan speed"),
+    hwinfoSensor("System", "Physical Memory Used"),
+    hwinfoSensor("System", "Physical Memory Available"),
+    afterburnerSensor("Core clock"),
+    afterburnerSensor("Memory clock"),
+    hwinfoSensor("ASRock X570 Steel Legend (Nuvoton NCT6796D)", "CPU2"),
+    afterburnerSensor("CPU clock"),
+    hwinfoSensor(NETWORK_GROUP, "Current UP rate"),
+    hwinfoSensor(NETWORK_GROUP, "Current DL rate"),
+};
+constexpr SensorTable<SCREEN_SENSOR_COUNT> SCREEN_SENSOR_TABLE = makeSensorTable(SCREEN_SENSORS);
+static_assert(SCREEN_SENSOR_TABLE.perfect, "a screen sensor is listed twice");
+const SensorTableView SCREEN_SENSOR_VIEW = SCREEN_SENSOR_TABLE.view();
+
+// In ScreenHistoryValue order; window 0 is the last SCREEN_HISTORY_WINDOW_MS. The session is
+// every poll since the host started, with the framerate's idle zeros (no 3D application running)
+// skipped: the mean framerate is of the polls made while gaming, and as every poll is a sample,
+// at the poll interval that is a time average.
+constexpr SensorHistoryQuery SCREEN_HISTORY_QUERIES[] = {
+    {GPU_TEMPERATURE, 0, SENSOR_MAX},
+    {FRAMERATE, SENSOR_SESSION_WINDOW, SENSOR_MEAN},
+};
+constexpr unsigned int SCREEN_HISTORY_QUERY_COUNT =
+    sizeof(SCREEN_HISTORY_QUERIES) / sizeof(SCREEN_HISTORY_QUERIES[0]);
+static_assert(SCREEN_SENSOR_COUNT + SCREEN_HISTORY_QUERY_COUNT == SCREEN_HISTORY_END,
+              "a history value has no query");
+const SensorHistoryConfig SCREEN_HISTORY = {0,
+                                            1,
+                                            {SCREEN_HISTORY_WINDOW_MS},
+                                            SCREEN_HISTORY_QUERIES,
+                                            SCREEN_HISTORY_QUERY_COUNT,
+                                            1u << FRAMERATE};
+
+// In ScreenMetricValue order. At two polls a second, smoothing over two or three seconds steadies
+// the digits without lagging far behind. The 1% low leaves out the framerate's idle zeros, which
+// would otherwise soon make it 0 for good, and starts over with a game that follows a minute or
+// more with no 3D application running: it is of the current or last game, not of the session.
+constexpr SensorMetric SCREEN_METRIC_LIST[] = {
+    emaMetric(FRAMERATE, 2000),
+    emaMetric(CPU_USAGE, 2000),
+    emaMetric(UPLOAD_RATE, 3000),
+    emaMetric(DOWNLOAD_RATE, 3000),
+    idleQuantileMetric(FRAMERATE, 0.01, 60 * 1000),
+};
+constexpr unsigned int SCREEN_METRIC_COUNT =
+    sizeof(SCREEN_METRIC_LIST) / sizeof(SCREEN_METRIC_LIST[0]);
+static_assert(SCREEN_HISTORY_END + SCREEN_METRIC_COUNT == SCREEN_VALUE_COUNT,
+              "a metric value has no metric");
+static_assert(SCREEN_VALUE_COUNT <= SENSOR_SNAPSHOT_CAPACITY, "too many screen values");
+const SensorMetricsConfig SCREEN_METRICS = {SCREEN_METRIC_LIST, SCREEN_METRIC_COUNT};
 
 /*
 GPU 00° 00% FPS 0000
 CPU 00° 00% FAN 00%
 CORE 0000   MEM 0000
 */
-bool createScreen1(char *screen, int screenLength, json_value *jsonData, char *error,
-                   int errorLength) {
+bool createScreen1(char *screen, int screenLength, const struct SensorSnapshot *snapshot,
+                   char *error, int errorLength) {
     char defaultScreen[] = "SCNGPU --%c --%% FPS ----CPU --%c --%% FAN ---%%RAM -----MB/-----MB ";
     snprintf(screen, screenLength, defaultScreen, DEGREE_SYMBOL, DEGREE_SYMBOL);
-    if (!jsonValueHasType(jsonData, json_object)) {
+    if (!snapshot->object) {
         strncpy(error, "Error: Failed to parse JSON", errorLength);
         return false;
     }
-    json_value *afterburner = getValueOfKeyIfHasType(jsonData, "afterburner", json_object);
-    json_value *hwinfo = getValueOfKeyIfHasType(jsonData, "hwinfo", json_object);
-    if (afterburner == NULL) {
+    if (!sensorSnapshotHasSource(snapshot, AFTERBURNER_SENSOR)) {
         strncpy(error, "Error: Afterburner is not running", errorLength);
         return false;
     }
-    if (hwinfo == NULL) {
+    if (!sensorSnapshotHasSource(snapshot, HWINFO_SENSOR)) {
         strncpy(error, "Error: HWInfo is not running", errorLength);
         return false;
     }
 
-    double gpuTemp = getAfterburnerSensorValue(afterburner, "GPU temperature");
-    double gpuUsage = getAfterburnerSensorValue(afterburner, "GPU usage");
-    double framerate = getAfterburnerSensorValue(afterburner, "Framerate");
-    double cpuTemp = getAfterburnerSensorValue(afterburner, "CPU temperature");
-    double cpuUsage = getAfterburnerSensorValue(afterburner, "CPU usage");
-    double fanSpeed = getAfterburnerSensorValue(afterburner, "Fan speed");
-    double memoryUsed = getHwinfoSensorValue(hwinfo, "Physical Memory Used", "System");
-    double memoryAvailable = getHwinfoSensorValue(hwinfo, "Physical Memory Available", "System");
+    double gpuTemp = sensorSnapshotValue(snapshot, GPU_TEMPERATURE);
+    double gpuUsage = sensorSnapshotValue(snapshot, GPU_USAGE);
+    double framerate = sensorSnapshotValue(snapshot, SMOOTH_FRAMERATE);
+    double cpuTemp = sensorSnapshotValue(snapshot, CPU_TEMPERATURE);
+    double cpuUsage = sensorSnapshotValue(snapshot, SMOOTH_CPU_USAGE);
+    double fanSpeed = sensorSnapshotValue(snapshot, FAN_SPEED);
+    double memoryUsed = sensorSnapshotValue(snapshot, MEMORY_USED);
+    double memoryAvailable = sensorSnapshotValue(snapshot, MEMORY_AVAILABLE);
     double totalMemory = memoryUsed + memoryAvailable;
 
     gpuTemp = whicheverIsLower(gpuTemp, 99);
@@ -59,25 +116,24 @@ CORE 0000   MEM 0000
 PUMP 0000   CPU 0000
 UP 00000K  DN 00000K
 */
-bool createScreen2(char *screen, int screenTextLength, json_value *jsonData, char *error,
-                   int errorLength) {
+bool createScreen2(char *screen, int screenTextLength, const struct SensorSnapshot *snapshot,
+                   char *error, int errorLength) {
     char defaultScreen[] = "SCNCORE ----   MEM ----PUMP ----   CPU ----UP -----K  DN -----K";
     snprintf(screen, screenTextLength, defaultScreen);
-    json_value *afterburner = getValueOfKeyIfHasType(jsonData, "afterburner", json_object);
-    json_value *hwinfo = getValueOfKeyIfHasType(jsonData, "hwinfo", json_object);
-    if (afterburner == NULL)
+    if (!snapshot->object) {
+        strncpy(error, "Error: Failed to parse JSON", errorLength);
         return false;
-    if (hwinfo == NULL)
+    }
+    if (!sensorSnapshotHasSource(snapshot, AFTERBURNER_SENSOR))
+        return false;
+    if (!sensorSnapshotHasSource(snapshot, HWINFO_SENSOR))
         return false;
-    double coreClock = getAfterburnerSensorValue(afterburner, "Core clock");
-    double memoryClock = getAfterburnerSensorValue(afterburner, "Memory clock");
-    double pumpSpeed =
-        getHwinfoSensorValue(hwinfo, "CPU2", "ASRock X570 Steel Legend (Nuvoton NCT6796D)");
-    double cpuClock = getAfterburnerSensorValue(afterburner, "CPU clock");
-    double upload = getHwinfoSensorValue(
-        hwinfo, "Current UP rate", "Network: Broadcom 802.11ac Wireless PCIE Full Dongle Adapter");
-    double download = getHwinfoSensorValue(
-        hwinfo, "Current DL rate", "Network: Broadcom 802.11ac Wireless PCIE Full Dongle Adapter");
+    double coreClock = sensorSnapshotValue(snapshot, CORE_CLOCK);
+    double memoryClock = sensorSnapshotValue(snapshot, MEMORY_CLOCK);
+    double pumpSpeed = sensorSnapshotValue(snapshot, PUMP_SPEED);
+    double cpuClock = sensorSnapshotValue(snapshot, CPU_CLOCK);
+    double upload = sensorSnapshotValue(snapshot, SMOOTH_UPLOAD_RATE);
+    double download = sensorSnapshotValue(snapshot, SMOOTH_DOWNLOAD_RATE);
 
     coreClock = whicheverIsLower(coreClock, 9999);
     memoryClock = whicheverIsLower(memoryClock, 9999);
@@ -91,3 +147,26 @@ bool createScreen2(char *screen, int screenTextLength, json_value *jsonData, cha
              cpuClock, upload, download);
     return true;
 }
+
+/*
+Peak GPU 00° Avg FPS 000   under screen 1
+1% low FPS 000             under screen 2
+*/
+bool createHistoryText(char *text, int textLength, const struct SensorSnapshot *snapshot,
+                       int whichScreen) {
+    if (whichScreen == 1) {
+        if (!sensorSnapshotIsValid(snapshot, LOW_FRAMERATE))
+            return false;
+        double lowFramerate = whicheverIsLower(sensorSnapshotValue(snapshot, LOW_FRAMERATE), 9999);
+        snprintf(text, textLength, "1%% low FPS %.0f", lowFramerate);
+        return true;
+    }
+    if (!sensorSnapshotIsValid(snapshot, PEAK_GPU_TEMPERATURE) ||
+        !sensorSnapshotIsValid(snapshot, MEAN_FRAMERATE))
+        return false;
+    double peakGpuTemp = whicheverIsLower(sensorSnapshotValue(snapshot, PEAK_GPU_TEMPERATURE), 99);
+    double meanFramerate = whicheverIsLower(sensorSnapshotValue(snapshot, MEAN_FRAMERATE), 9999);
+    snprintf(text, textLength, "Peak GPU %.0f%c Avg FPS %.0f", peakGpuTemp, DEGREE_SYMBOL,
+             meanFramerate);
+    return true;
+}
@@ -1,4 +1,8 @@
 #include "json-parser/json.h"
+#include "sensor-history.hpp"
+#include "sensor-metrics.hpp"
+#include "sensor-snapshot.hpp"
+#include "sensor-table.hpp"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -6,7 +10,55 @@ const int SCREEN_TEXT_LENGTH = 63;
 const char BLANK_SCREEN[] = "SCN                                                            ";
 const char SCROLL_TEXT_LENGTH = 63;
 
-bool createScreen1(char *screen, int screenTextLength, json_value *jsonData, char *error,
-                   int errorLength);
-bool createScreen2(char *screen, int screenTextLength, json_value *jsonData, char *error,
-                   int errorLength);
\ No newline at end of file
+// The sensors both screens show, numbered as in SCREEN_SENSOR_VIEW and a snapshot of it.
+enum ScreenSensor {
+    GPU_TEMPERATURE,
+    GPU_USAGE,
+    FRAMERATE,
+    CPU_TEMPERATURE,
+    CPU_USAGE,
+    FAN_SPEED,
+    MEMORY_USED,
+    MEMORY_AVAILABLE,
+    CORE_CLOCK,
+    MEMORY_CLOCK,
+    PUMP_SPEED,
+    CPU_CLOCK,
+    UPLOAD_RATE,
+    DOWNLOAD_RATE,
+    SCREEN_SENSOR_COUNT
+};
+
+// What the screens read from a source's history, in the snapshot after the sensors.
+enum ScreenHistoryValue {
+    PEAK_GPU_TEMPERATURE = SCREEN_SENSOR_COUNT,
+    MEAN_FRAMERATE,
+    SCREEN_HISTORY_END
+};
+
+// What the screens derive from those, in the snapshot after the history values.
+enum ScreenMetricValue {
+    SMOOTH_FRAMERATE = SCREEN_HISTORY_END,
+    SMOOTH_CPU_USAGE,
+    SMOOTH_UPLOAD_RATE,
+    SMOOTH_DOWNLOAD_RATE,
+    LOW_FRAMERATE, // the 1% low of the framerate samples of the current or last game
+    SCREEN_VALUE_COUNT
+};
+
+const long long SCREEN_HISTORY_WINDOW_MS = 5 * 60 * 1000;
+
+extern const SensorTableView SCREEN_SENSOR_VIEW;
+// The history's windows and queries; its capacity is up to the host, which knows how often it
+// polls.
+extern const SensorHistoryConfig SCREEN_HISTORY;
+extern const SensorMetricsConfig SCREEN_METRICS;
+
+bool createScreen1(char *screen, int screenTextLength, const struct SensorSnapshot *snapshot,
+                   char *error, int errorLength);
+bool createScreen2(char *screen, int screenTextLength, const struct SensorSnapshot *snapshot,
+                   char *error, int errorLength);
+// For the scroll text under screen whichScreen (0 or 1, as in windows_host), once the snapshot has
+// the values it shows; returns false otherwise. The scroll text only has room for a few.
+bool createHistoryText(char *text, int textLength, const struct SensorSnapshot *snapshot,
+                       int whichScreen);
\ No newline at end of file
@@ -0,0 +1,240 @@
+#include "sensor-history.hpp"
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+
+// Hands out the next bytes of memory, kept 8-byte aligned; with no memory, only counts them.
+static void *carve(char *memory, size_t *used, size_t bytes) {
+    void *at = memory != NULL ? memory + *used : NULL;
+    *used += (bytes + 7) & ~(size_t)7;
+    return at;
+}
+
+// Points the history's arrays into memory, times first, and returns how many bytes they take.
+static size_t layOutSensorHistory(struct SensorHistory *history, char *memory) {
+    size_t capacity = history->config.capacity;
+    size_t states = (size_t)history->config.windowCount * history->sensorCount;
+    size_t used = 0;
+    history->times = (long long *)carve(memory, &used, capacity * sizeof(long long));
+    history->windows =
+        (struct SensorWindowState *)carve(memory, &used, states * sizeof(SensorWindowState));
+    history->session = (struct SensorWindowStats *)carve(
+        memory, &used, history->sensorCount * sizeof(SensorWindowStats));
+    history->valid =
+        (uint32_t *)carve(memory, &used, capacity * history->validWords * sizeof(uint32_t));
+    history->values =
+        (int32_t *)carve(memory, &used, history->sensorCount * capacity * sizeof(int32_t));
+    history->minQueues = (uint32_t *)carve(memory, &used, states * capacity * sizeof(uint32_t));
+    history->maxQueues = (uint32_t *)carve(memory, &used, states * capacity * sizeof(uint32_t));
+    return used;
+}
+
+size_t sensorHistoryBytes(unsigned int sensorCount, const struct SensorHistoryConfig *config) {
+    struct SensorHistory history;
+    history.config = *config;
+    history.sensorCount = sensorCount;
+    history.validWords = (sensorCount + 31) / 32;
+    return layOutSensorHistory(&history, NULL);
+}
+
+bool sensorHistoryInit(struct SensorHistory *history, unsigned int sensorCount,
+                       const struct SensorHistoryConfig *config) {
+    memset(history, 0, sizeof(*history));
+    if (config->capacity == 0 || config->windowCount > SENSOR_HISTORY_MAX_WINDOWS)
+        return false;
+    for (unsigned int i = 0; i < config->queryCount; i++) {
+        const SensorHistoryQuery *query = &config->queries[i];
+        if (query->sensor >= sensorCount)
+            return false;
+        if (query->window != SENSOR_SESSION_WINDOW &&
+            (query->window < 0 || query->window >= (int)config->windowCount))
+            return false;
+    }
+    history->config = *config;
+    history->sensorCount = sensorCount;
+    history->validWords = (sensorCount + 31) / 32;
+    history->bytes = layOutSensorHistory(history, NULL);
+    char *memory = (char *)calloc(1, history->bytes);
+    if (memory == NULL)
+        return false;
+    layOutSensorHistory(history, memory);
+    return true;
+}
+
+void sensorHistoryFree(struct SensorHistory *history) {
+    free(history->times);
+    memset(history, 0, sizeof(*history));
+}
+
+// The sample a queue entry, the low 32 bits of its number, stands for.
+static unsigned long long queuedSample(const struct SensorHistory *history, uint32_t entry) {
+    return history->appended - (uint32_t)((uint32_t)history->appended - entry);
+}
+
+static int32_t sampleValue(const struct SensorHistory *history, unsigned int sensor,
+                           unsigned long long sample) {
+    return history->values[(size_t)sensor * history->config.capacity +
+                           sample % history->config.capacity];
+}
+
+static bool isSampleValid(const uint32_t *valid, unsigned int sensor) {
+    return (valid[sensor / 32] >> (sensor % 32) & 1) != 0;
+}
+
+static void dropExpired(const struct SensorHistory *history, const uint32_t *queue,
+                        uint32_t *head, uint32_t *length, unsigned long long start) {
+    while (*length > 0 && queuedSample(history, queue[*head]) < start) {
+        *head = *head + 1 == history->config.capacity ? 0 : *head + 1;
+        (*length)--;
+    }
+}
+
+// Queues sample after dropping, from the back, every sample it beats: one that is no lower (or,
+// for a max queue, no higher) can never be the window's min again, as it leaves first.
+static void pushSample(const struct SensorHistory *history, unsigned int sensor, uint32_t *queue,
+                       uint32_t *head, uint32_t *length, unsigned long long sample, bool max) {
+    uint32_t capacity = history->config.capacity;
+    int32_t value = sampleValue(history, sensor, sample);
+    while (*length > 0) {
+        uint32_t back = *head + *length - 1;
+        if (back >= capacity)
+            back -= capacity;
+        int32_t queued = sampleValue(history, sensor, queuedSample(history, queue[back]));
+        if (max ? queued > value : queued < value)
+            break;
+        (*length)--;
+    }
+    uint32_t tail = *head + *length;
+    if (tail >= capacity)
+        tail -= capacity;
+    queue[tail] = (uint32_t)sample;
+    (*length)++;
+}
+
+// Moves window past the samples older than its length at timeMs, and the one the next sample
+// overwrites.
+static void expireWindow(struct SensorHistory *history, unsigned int window, long long timeMs) {
+    unsigned int capacity = history->config.capacity;
+    unsigned long long start = history->windowStart[window];
+    long long oldest = timeMs - history->config.windowMs[window];
+    struct SensorWindowState *states = &history->windows[(size_t)window * history->sensorCount];
+    for (; start < history->appended && (start + capacity <= history->appended ||
+                                         history->times[start % capacity] <= oldest);
+         start++) {
+        const uint32_t *valid = &history->valid[start % capacity * history->validWords];
+        for (unsigned int sensor = 0; sensor < history->sensorCount; sensor++) {
+            if (!isSampleValid(valid, sensor))
+                continue;
+            states[sensor].sum -= sampleValue(history, sensor, start);
+            states[sensor].count--;
+        }
+    }
+    if (start == history->windowStart[window])
+        return;
+    history->windowStart[window] = start;
+    size_t queues = (size_t)window * history->sensorCount * capacity;
+    for (unsigned int sensor = 0; sensor < history->sensorCount; sensor++) {
+        struct SensorWindowState *state = &states[sensor];
+        size_t queue = queues + (size_t)sensor * capacity;
+        dropExpired(history, &history->minQueues[queue], &state->minHead, &state->minLength,
+                    start);
+        dropExpired(history, &history->maxQueues[queue], &state->maxHead, &state->maxLength,
+                    start);
+    }
+}
+
+void sensorHistoryAppend(struct SensorHistory *history, long long timeMs, const int32_t *values,
+                         const uint32_t *valid) {
+    unsigned int capacity = history->config.capacity;
+    unsigned long long sample = history->appended;
+    for (unsigned int window = 0; window < history->config.windowCount; window++)
+        expireWindow(history, window, timeMs);
+
+    size_t slot = sample % capacity;
+    uint32_t *slotValid = &history->valid[slot * history->validWords];
+    history->times[slot] = timeMs;
+    memset(slotValid, 0, history->validWords * sizeof(uint32_t));
+    history->appended = sample + 1;
+    for (unsigned int sensor = 0; sensor < history->sensorCount; sensor++) {
+        bool isValid = isSampleValid(valid, sensor);
+        int32_t value = isValid ? values[sensor] : 0;
+        if (value == 0 && sensor < 32 && (history->config.skipZero >> sensor & 1))
+            isValid = false;
+        history->values[(size_t)sensor * capacity + slot] = value;
+        if (!isValid)
+            continue;
+        slotValid[sensor / 32] |= (uint32_t)1 << (sensor % 32);
+        struct SensorWindowStats *session = &history->session[sensor];
+        if (session->count == 0 || value < session->min)
+            session->min = value;
+        if (session->count == 0 || value > session->max)
+            session->max = value;
+        session->sum += value;
+        session->count++;
+        for (unsigned int window = 0; window < history->config.windowCount; window++) {
+            size_t state = (size_t)window * history->sensorCount + sensor;
+            struct SensorWindowState *windowState = &history->windows[state];
+            windowState->sum += value;
+            windowState->count++;
+            pushSample(history, sensor, &history->minQueues[state * capacity],
+                       &windowState->minHead, &windowState->minLength, sample, false);
+            pushSample(history, sensor, &history->maxQueues[state * capacity],
+                       &windowState->maxHead, &windowState->maxLength, sample, true);
+        }
+    }
+}
+
+bool sensorHistoryWindow(const struct SensorHistory *history, unsigned int sensor, int window,
+                         struct SensorWindowStats *stats) {
+    if (window == SENSOR_SESSION_WINDOW) {
+        *stats = history->session[sensor];
+        return stats->count > 0;
+    }
+    size_t state = (size_t)window * history->sensorCount + sensor;
+    const struct SensorWindowState *windowState = &history->windows[state];
+    stats->count = windowState->count;
+    stats->sum = windowState->sum;
+    if (stats->count == 0)
+        return false;
+    size_t queue = state * history->config.capacity;
+    stats->min = sampleValue(
+        history, sensor,
+        queuedSample(history, history->minQueues[queue + windowState->minHead]));
+    stats->max = sampleValue(
+        history, sensor,
+        queuedSample(history, history->maxQueues[queue + windowState->maxHead]));
+    return true;
+}
+
+// Rounded to the nearest, like the values themselves.
+int32_t sensorWindowAggregate(const struct SensorWindowStats *stats, SensorAggregate aggregate) {
+    if (aggregate == SENSOR_MIN)
+        return stats->min;
+    if (aggregate == SENSOR_MAX)
+        return stats->max;
+    int64_t count = stats->count;
+    if (stats->sum < 0)
+        return (int32_t)-((-stats->sum + count / 2) / count);
+    return (int32_t)((stats->sum + count / 2) / count);
+}
+
+void sensorHistoryAppendSnapshot(struct SensorHistory *history, struct SensorSnapshot *snapshot) {
+    long long timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           snapshot->receivedAt.time_since_epoch())
+                           .count();
+    sensorHistoryAppend(history, timeMs, snapshot->values, &snapshot->valid);
+    unsigned int count = history->sensorCount;
+    for (unsigned int i = 0; i < history->config.queryCount; i++, count++) {
+        if (count >= (unsigned int)SENSOR_SNAPSHOT_CAPACITY)
+            break;
+        const SensorHistoryQuery *query = &history->config.queries[i];
+        struct SensorWindowStats stats;
+        snapshot->values[count] = 0;
+        snapshot->valid &= ~((uint32_t)1 << count);
+        if (!sensorHistoryWindow(history, query->sensor, query->window, &stats))
+            continue;
+        snapshot->values[count] = sensorWindowAggregate(&stats, query->aggregate);
+        snapshot->valid |= (uint32_t)1 << count;
+    }
+    snapshot->count = count;
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "sensor-snapshot.hpp"
+#include <stddef.h>
+#include <stdint.h>
+
+const int SENSOR_HISTORY_MAX_WINDOWS = 4;
+// A query over every sample appended since the history was created, however old.
+const int SENSOR_SESSION_WINDOW = -1;
+
+enum SensorAggregate { SENSOR_MIN, SENSOR_MAX, SENSOR_MEAN };
+
+// One aggregate of one sensor, read into every snapshot after the sensors themselves.
+struct SensorHistoryQuery {
+    unsigned int sensor;
+    int window; // into SensorHistoryConfig::windowMs, or SENSOR_SESSION_WINDOW
+    SensorAggregate aggregate;
+};
+
+struct SensorHistoryConfig {
+    // Samples kept per sensor, which bounds the memory used. A window holds the samples of its
+    // last windowMs milliseconds, or the last capacity samples if those cover less.
+    unsigned int capacity;
+    unsigned int windowCount;
+    long long windowMs[SENSOR_HISTORY_MAX_WINDOWS];
+    const SensorHistoryQuery *queries;
+    unsigned int queryCount;
+    // Bit s for each of the first 32 sensors whose 0 means idle rather than a reading, such as
+    // Afterburner's framerate with no 3D application running: a sample of 0 from it is left out
+    // like an invalid one.
+    uint32_t skipZero;
+};
+
+// In the snapshot's fixed point; min and max mean nothing while count is 0. The mean is per
+// sample, not per unit of time; samples taken at a steady rate make it a time average.
+struct SensorWindowStats {
+    unsigned int count; // valid samples
+    int32_t min;
+    int32_t max;
+    int64_t sum;
+};
+
+// A sensor's running sum over a window, and the sample numbers its min and max can still come
+// from (monotonic deques: each value is below, or above, every one queued before it).
+struct SensorWindowState {
+    int64_t sum;
+    uint32_t count;
+    uint32_t minHead, minLength;
+    uint32_t maxHead, maxLength;
+};
+
+/*
+The last capacity samples of every sensor, in memory allocated once by sensorHistoryInit. Samples
+are numbered from 0 as they are appended and sample n lives in slot n % capacity. The values of
+one sensor are contiguous, one array per sensor, with the sample times and validity bits shared.
+
+Each append moves every window past the samples that have grown too old and updates its sums and
+deques, so that reading a window's min, max or mean is a lookup, whatever the window's length: a
+sample enters and leaves each deque at most once, which makes appending O(1) per sensor and window
+amortized.
+*/
+struct SensorHistory {
+    struct SensorHistoryConfig config;
+    unsigned int sensorCount;
+    unsigned int validWords; // uint32_t words of validity bits per sample
+    unsigned long long appended;
+    long long *times;   // [capacity]: in milliseconds
+    uint32_t *valid;    // [capacity][validWords]: of the samples kept, skipped zeros left out
+    int32_t *values;    // [sensorCount][capacity]
+    unsigned long long windowStart[SENSOR_HISTORY_MAX_WINDOWS]; // the oldest sample in the window
+    struct SensorWindowState *windows; // [windowCount][sensorCount]
+    uint32_t *minQueues; // [windowCount][sensorCount][capacity]: low 32 bits of sample numbers
+    uint32_t *maxQueues;
+    struct SensorWindowStats *session; // [sensorCount]
+    size_t bytes;
+};
+
+// Bytes a history of sensorCount sensors configured so allocates.
+size_t sensorHistoryBytes(unsigned int sensorCount, const struct SensorHistoryConfig *config);
+// Returns false if config is not usable (no capacity, too many windows, a query out of range) or
+// memory runs out. config->queries must outlive the history.
+bool sensorHistoryInit(struct SensorHistory *history, unsigned int sensorCount,
+                       const struct SensorHistoryConfig *config);
+void sensorHistoryFree(struct SensorHistory *history);
+
+// Appends a sample of every sensor taken at timeMs, which never goes back: values[s], if bit s
+// of valid (the bits of sensor s are valid[s / 32], from its lowest) is set and it is not a
+// skipped zero.
+void sensorHistoryAppend(struct SensorHistory *history, long long timeMs, const int32_t *values,
+                         const uint32_t *valid);
+// The valid samples of a sensor in a window, or in SENSOR_SESSION_WINDOW. Returns false if there
+// are none.
+bool sensorHistoryWindow(const struct SensorHistory *history, unsigned int sensor, int window,
+                         struct SensorWindowStats *stats);
+int32_t sensorWindowAggregate(const struct SensorWindowStats *stats, SensorAggregate aggregate);
+
+// Appends the snapshot's sensors at its receivedAt, one sample per snapshot, then reads the
+// configured queries into it: query q becomes value sensorCount + q, and the snapshot's count
+// grows to cover them.
+void sensorHistoryAppendSnapshot(struct SensorHistory *history, struct SensorSnapshot *snapshot);
@@ -0,0 +1,191 @@
+#include "sensor-metrics.hpp"
+#include <chrono>
+#include <math.h>
+#include <string.h>
+
+bool sensorMetricsInit(struct SensorMetrics *metrics, const struct SensorMetricsConfig *config) {
+    memset(metrics, 0, sizeof(*metrics));
+    if (config->count > SENSOR_SNAPSHOT_CAPACITY)
+        return false;
+    for (unsigned int i = 0; i < config->count; i++) {
+        const SensorMetric *metric = &config->metrics[i];
+        if (metric->kind == METRIC_QUANTILE && !(metric->quantile > 0 && metric->quantile < 1))
+            return false;
+    }
+    metrics->config = *config;
+    return true;
+}
+
+void sensorMetricsReset(struct SensorMetrics *metrics, unsigned int metric) {
+    memset(&metrics->states[metric], 0, sizeof(metrics->states[metric]));
+}
+
+// Whether a sample is a reading: not an idle 0, with skipZero. Starts the metric over when it
+// comes after long enough idle.
+static bool takeSample(struct SensorMetrics *metrics, unsigned int metric, long long timeMs,
+                       double sample) {
+    const SensorMetric *declared = &metrics->config.metrics[metric];
+    struct SensorMetricState *state = &metrics->states[metric];
+    if (!declared->skipZero)
+        return true;
+    if (sample == 0) {
+        if (!state->idle)
+            state->idleSinceMs = timeMs;
+        state->idle = true;
+        return false;
+    }
+    if (state->idle && declared->resetAfterIdleMs > 0 &&
+        timeMs - state->idleSinceMs >= declared->resetAfterIdleMs)
+        sensorMetricsReset(metrics, metric);
+    state->idle = false;
+    return true;
+}
+
+// The weight of a new sample that comes elapsedMs after the last, for a time constant of
+// smoothingMs: all of it with no smoothing.
+static double smoothingWeight(long long elapsedMs, long long smoothingMs) {
+    if (smoothingMs <= 0)
+        return 1;
+    if (elapsedMs <= 0)
+        return 0;
+    return 1 - exp(-(double)elapsedMs / smoothingMs);
+}
+
+static void updateEma(const SensorMetric *metric, struct SensorMetricState *state, long long timeMs,
+                      double sample) {
+    if (state->samples == 0)
+        state->value = sample;
+    else
+        state->value += smoothingWeight(timeMs - state->lastMs, metric->smoothingMs) *
+                        (sample - state->value);
+    state->lastMs = timeMs;
+    state->valid = true;
+}
+
+// Two samples at the same time have no rate between them; the second is skipped.
+static void updateRate(const SensorMetric *metric, struct SensorMetricState *state,
+                       long long timeMs, double sample) {
+    long long elapsedMs = timeMs - state->lastMs;
+    if (state->samples > 0 && elapsedMs <= 0)
+        return;
+    if (state->samples > 0) {
+        double rate = (sample - state->last) * 1000 / elapsedMs;
+        if (!state->valid)
+            state->value = rate;
+        else
+            state->value += smoothingWeight(elapsedMs, metric->smoothingMs) * (rate - state->value);
+        state->valid = true;
+    }
+    state->last = sample;
+    state->lastMs = timeMs;
+}
+
+static void sortHeights(double *heights, int count) {
+    for (int i = 1; i < count; i++)
+        for (int j = i; j > 0 && heights[j - 1] > heights[j]; j--) {
+            double height = heights[j];
+            heights[j] = heights[j - 1];
+            heights[j - 1] = height;
+        }
+}
+
+// Moves marker i by direction (1 or -1) position, its height along the parabola through it and
+// its neighbours, or the line to the neighbour it moves towards when the parabola would leave
+// them out of order.
+static void moveMarker(struct SensorMetricState *state, int i, int direction) {
+    double *q = state->heights;
+    double *n = state->positions;
+    double d = direction;
+    double height =
+        q[i] + d / (n[i + 1] - n[i - 1]) *
+                   ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+                    (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+    if (!(q[i - 1] < height && height < q[i + 1]))
+        height = q[i] + d * (q[i + direction] - q[i]) / (n[i + direction] - n[i]);
+    q[i] = height;
+    n[i] += d;
+}
+
+static void updateQuantile(const SensorMetric *metric, struct SensorMetricState *state,
+                           double sample) {
+    double p = metric->quantile;
+    double *q = state->heights;
+    double *n = state->positions;
+    if (state->samples < 5) {
+        q[state->samples] = sample;
+        int count = (int)state->samples + 1;
+        double sorted[5];
+        memcpy(sorted, q, sizeof(sorted));
+        sortHeights(sorted, count);
+        state->value = sorted[(int)(p * (count - 1) + 0.5)];
+        state->valid = true;
+        if (count < 5)
+            return;
+        sortHeights(q, 5);
+        for (int i = 0; i < 5; i++)
+            n[i] = i;
+        state->desired[0] = 0;
+        state->desired[1] = 2 * p;
+        state->desired[2] = 4 * p;
+        state->desired[3] = 2 + 2 * p;
+        state->desired[4] = 4;
+        return;
+    }
+
+    int cell;
+    if (sample < q[0]) {
+        q[0] = sample;
+        cell = 0;
+    } else if (sample >= q[4]) {
+        q[4] = sample;
+        cell = 3;
+    } else {
+        for (cell = 0; sample >= q[cell + 1]; cell++)
+            ;
+    }
+    for (int i = cell + 1; i < 5; i++)
+        n[i]++;
+    const double increments[5] = {0, p / 2, p, (1 + p) / 2, 1};
+    for (int i = 0; i < 5; i++)
+        state->desired[i] += increments[i];
+    for (int i = 1; i < 4; i++) {
+        double offset = state->desired[i] - n[i];
+        if (offset >= 1 && n[i + 1] - n[i] > 1)
+            moveMarker(state, i, 1);
+        else if (offset <= -1 && n[i - 1] - n[i] < -1)
+            moveMarker(state, i, -1);
+    }
+    state->value = q[2];
+}
+
+void sensorMetricsAppendSnapshot(struct SensorMetrics *metrics, struct SensorSnapshot *snapshot) {
+    long long timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           snapshot->receivedAt.time_since_epoch())
+                           .count();
+    unsigned int count = snapshot->count;
+    for (unsigned int i = 0; i < metrics->config.count; i++, count++) {
+        if (count >= (unsigned int)SENSOR_SNAPSHOT_CAPACITY)
+            break;
+        const SensorMetric *metric = &metrics->config.metrics[i];
+        struct SensorMetricState *state = &metrics->states[i];
+        snapshot->values[count] = 0;
+        snapshot->valid &= ~((uint32_t)1 << count);
+        if (metric->sensor >= count || !sensorSnapshotIsValid(snapshot, metric->sensor))
+            continue;
+        double sample = sensorSnapshotValue(snapshot, metric->sensor);
+        if (takeSample(metrics, i, timeMs, sample)) {
+            if (metric->kind == METRIC_EMA)
+                updateEma(metric, state, timeMs, sample);
+            else if (metric->kind == METRIC_RATE)
+                updateRate(metric, state, timeMs, sample);
+            else
+                updateQuantile(metric, state, sample);
+            state->samples++;
+        }
+        if (!state->valid)
+            continue;
+        snapshot->values[count] = sensorSnapshotFixed(state->value);
+        snapshot->valid |= (uint32_t)1 << count;
+    }
+    snapshot->count = count;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "sensor-snapshot.hpp"
+
+enum SensorMetricKind { METRIC_EMA, METRIC_RATE, METRIC_QUANTILE };
+
+/*
+A value derived from one value of a snapshot, updated once per snapshot in O(1) time and space:
+    METRIC_EMA       an exponential moving average with a time constant of smoothingMs, which
+                     weighs samples by how far apart they came rather than by how many there are
+    METRIC_RATE      the change per second between consecutive valid samples, itself smoothed
+                     the same way when smoothingMs is not 0
+    METRIC_QUANTILE  the quantile of every valid sample so far, estimated with the P-square
+                     algorithm (Jain and Chlamtac), which keeps five markers instead of the samples
+sensor is the number of the value in the snapshot: a sensor of the table, a history query, or a
+metric listed before this one.
+
+With skipZero, a 0 from the sensor means idle rather than a reading, as Afterburner's framerate
+is 0 with no 3D application running: the metric leaves it out and keeps its last value. Once the
+sensor has been idle for resetAfterIdleMs (not 0), the metric starts over with the next reading,
+so that a quantile covers one stretch of use, one game, rather than everything since startup.
+*/
+struct SensorMetric {
+    SensorMetricKind kind;
+    unsigned int sensor;
+    long long smoothingMs;
+    double quantile; // in (0, 1)
+    bool skipZero;
+    long long resetAfterIdleMs;
+};
+
+constexpr SensorMetric emaMetric(unsigned int sensor, long long smoothingMs) {
+    return SensorMetric{METRIC_EMA, sensor, smoothingMs, 0, false, 0};
+}
+
+constexpr SensorMetric rateMetric(unsigned int sensor, long long smoothingMs) {
+    return SensorMetric{METRIC_RATE, sensor, smoothingMs, 0, false, 0};
+}
+
+constexpr SensorMetric quantileMetric(unsigned int sensor, double quantile) {
+    return SensorMetric{METRIC_QUANTILE, sensor, 0, quantile, false, 0};
+}
+
+constexpr SensorMetric idleQuantileMetric(unsigned int sensor, double quantile,
+                                          long long resetAfterIdleMs) {
+    return SensorMetric{METRIC_QUANTILE, sensor, 0, quantile, true, resetAfterIdleMs};
+}
+
+struct SensorMetricsConfig {
+    const SensorMetric *metrics;
+    unsigned int count;
+};
+
+struct SensorMetricState {
+    unsigned long samples; // valid samples seen
+    long long lastMs;
+    double last;           // METRIC_RATE: the last valid sample
+    double value;          // the metric, once valid
+    bool valid;
+    bool idle;             // skipZero: the last sample was 0, as were those since idleSinceMs
+    long long idleSinceMs;
+    // METRIC_QUANTILE: the markers' heights and positions, and where they should be. Until there
+    // are five samples, heights holds them as they came.
+    double heights[5];
+    double positions[5];
+    double desired[5];
+};
+
+struct SensorMetrics {
+    struct SensorMetricsConfig config;
+    struct SensorMetricState states[SENSOR_SNAPSHOT_CAPACITY];
+};
+
+// Returns false if config has more metrics than a snapshot has room for, or a quantile out of
+// range. config->metrics must outlive the metrics.
+bool sensorMetricsInit(struct SensorMetrics *metrics, const struct SensorMetricsConfig *config);
+// Forgets everything metric m has seen, as if no sample had come yet.
+void sensorMetricsReset(struct SensorMetrics *metrics, unsigned int metric);
+// Updates every metric with the snapshot, taken at its receivedAt, and reads them into it:
+// metric m becomes value count + m, for the snapshot's count on the way in, which grows to cover
+// them. A metric whose sensor is not valid in this snapshot is not valid in it either.
+void sensorMetricsAppendSnapshot(struct SensorMetrics *metrics, struct SensorSnapshot *snapshot);
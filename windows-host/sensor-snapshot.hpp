@@ -0,0 +1,47 @@
+#pragma once
+#include <chrono>
+#include <stdint.h>
+
+const int SENSOR_SNAPSHOT_CAPACITY = 32;
+// Values are kept in hundredths.
+const int SENSOR_SNAPSHOT_SCALE = 100;
+
+/*
+The values of a SensorTable's sensors from one document, extracted by the poller thread as soon
+as the document is parsed; nothing the screens render needs the document after that. Sensor i of
+the table is values[i], valid if bit i of valid is set (a sensor missing from the document, or
+whose value is not a number, reads 0). A few hundred bytes, with no pointers, so it is copied
+between threads as it is.
+*/
+struct SensorSnapshot {
+    unsigned long sequence; // documents extracted so far, this one included; 0 for none yet
+    std::chrono::steady_clock::time_point receivedAt;
+    bool object;            // false if the document is not an object, and has no sensors at all
+    unsigned int sources;   // bit AFTERBURNER_SENSOR or HWINFO_SENSOR: present in the document
+    unsigned int count;
+    uint32_t valid;
+    int32_t values[SENSOR_SNAPSHOT_CAPACITY];
+};
+static_assert(SENSOR_SNAPSHOT_CAPACITY <= 32, "validity is kept in a uint32_t");
+
+inline bool sensorSnapshotHasSource(const SensorSnapshot *snapshot, int source) {
+    return (snapshot->sources & (1u << source)) != 0;
+}
+
+inline bool sensorSnapshotIsValid(const SensorSnapshot *snapshot, int sensor) {
+    return (snapshot->valid & (1u << sensor)) != 0;
+}
+
+inline double sensorSnapshotValue(const SensorSnapshot *snapshot, int sensor) {
+    return (double)snapshot->values[sensor] / SENSOR_SNAPSHOT_SCALE;
+}
+
+// Rounded to the nearest hundredth, and clamped to what fits.
+inline int32_t sensorSnapshotFixed(double value) {
+    double scaled = value * SENSOR_SNAPSHOT_SCALE;
+    if (scaled >= 2147483647.0)
+        return INT32_MAX;
+    if (scaled <= -2147483647.0)
+        return -INT32_MAX;
+    return (int32_t)(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+}
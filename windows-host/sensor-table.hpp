@@ -0,0 +1,117 @@
+#pragma once
+#include "json-parser/json.h"
+#include <stddef.h>
+
+/*
+Sensors declared at compile time. A screen lists the sensors it shows as constexpr descriptors,
+whose names the compiler measures and hashes (with json.c's FNV-1a, so a label is a json_key ready
+for json_tape_find_key or an HwinfoIndex), and makeSensorTable searches out a perfect hash over
+them: a name read from a document is matched against every sensor with one probe and one compare.
+
+    constexpr SensorDescriptor SENSORS[] = {afterburnerSensor("Framerate"),
+                                            hwinfoSensor("System", "Physical Memory Used")};
+    constexpr SensorTable<2> TABLE = makeSensorTable(SENSORS);
+    static_assert(TABLE.perfect, "a sensor is listed twice");
+*/
+
+enum SensorSource { AFTERBURNER_SENSOR, HWINFO_SENSOR };
+
+struct SensorDescriptor {
+    SensorSource source;
+    json_key group; // a reading's hwinfo.sensors group; no name for an Afterburner entry
+    json_key label; // an entry's name, or a reading's labelOriginal
+};
+
+constexpr size_t sensorNameLength(const char *name) {
+    size_t length = 0;
+    while (name[length] != '\0')
+        length++;
+    return length;
+}
+
+constexpr unsigned int sensorNameHash(const char *name, size_t length) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+        hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+    return hash;
+}
+
+constexpr json_key sensorKey(const char *name) {
+    return json_key{name, (unsigned int)sensorNameLength(name),
+                    sensorNameHash(name, sensorNameLength(name))};
+}
+
+constexpr SensorDescriptor afterburnerSensor(const char *name) {
+    return SensorDescriptor{AFTERBURNER_SENSOR, json_key{NULL, 0, 0}, sensorKey(name)};
+}
+
+constexpr SensorDescriptor hwinfoSensor(const char *group, const char *label) {
+    return SensorDescriptor{HWINFO_SENSOR, sensorKey(group), sensorKey(label)};
+}
+
+// A sensor's perfect hash is of its label's and its group's hashes (0 for Afterburner).
+constexpr unsigned int sensorHash(unsigned int labelHash, unsigned int groupHash) {
+    return labelHash ^ (groupHash * 0x9E3779B1u);
+}
+
+constexpr unsigned int sensorSlot(unsigned int hash, unsigned int seed, unsigned int bits) {
+    return ((hash ^ seed) * 0x85EBCA6Bu) >> (32 - bits);
+}
+
+// A table of any size, as the parser reads it: slot s holds the number of the sensor whose
+// perfect hash lands there, plus one, or 0.
+struct SensorTableView {
+    const SensorDescriptor *sensors;
+    unsigned int count;
+    const unsigned char *slots;
+    unsigned int seed;
+    unsigned int bits;
+};
+
+// Slots for count sensors: at least twice as many, so that a seed is found in a few tries.
+constexpr unsigned int sensorTableBits(size_t count) {
+    unsigned int bits = 2;
+    while (((size_t)1 << bits) < count * 2)
+        bits++;
+    return bits;
+}
+
+template <size_t N> struct SensorTable {
+    static_assert(N > 0 && N < 255, "slots hold sensor numbers in a byte");
+    static constexpr unsigned int BITS = sensorTableBits(N);
+
+    SensorDescriptor sensors[N];
+    unsigned char slots[1 << BITS];
+    unsigned int seed;
+    bool perfect; // false if no seed kept every sensor in a slot of its own
+
+    constexpr SensorTableView view() const {
+        return SensorTableView{sensors, N, slots, seed, BITS};
+    }
+};
+
+const unsigned int SENSOR_TABLE_MAX_SEEDS = 4096;
+
+template <size_t N>
+constexpr SensorTable<N> makeSensorTable(const SensorDescriptor (&sensors)[N]) {
+    SensorTable<N> table{};
+    for (size_t i = 0; i < N; i++)
+        table.sensors[i] = sensors[i];
+    for (unsigned int seed = 0; seed < SENSOR_TABLE_MAX_SEEDS; seed++) {
+        for (unsigned char &slot : table.slots)
+            slot = 0;
+        bool collided = false;
+        for (size_t i = 0; i < N && !collided; i++) {
+            unsigned int slot = sensorSlot(
+                sensorHash(sensors[i].label.hash, sensors[i].group.hash), seed, table.BITS);
+            collided = table.slots[slot] != 0;
+            table.slots[slot] = (unsigned char)(i + 1);
+        }
+        if (!collided) {
+            table.seed = seed;
+            table.perfect = true;
+            return table;
+        }
+    }
+    return table;
+}
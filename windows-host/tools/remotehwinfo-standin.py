@@ -0,0 +1,299 @@
+#!/usr/bin/env python3
+"""Local stand-in for RemoteHWInfo.
+
+Serves /json.json in the shape remotehwinfo-parser.cpp reads (afterburner.entries,
+hwinfo.sensors and hwinfo.readings) so the host can be run, benchmarked and regression tested
+without a Windows machine running HWiNFO, Afterburner and RemoteHWInfo.
+
+    python3 remotehwinfo-standin.py --port 27008 --readings 5000 --drift 0.02
+    python3 remotehwinfo-standin.py --readings 100000 --dump big.json
+    python3 remotehwinfo-standin.py --readings 5000 --dump d5000.json --polls 8
+
+The sensors the screens display are always present; --readings pads the document with
+synthetic readings spread over --groups additional sensor groups, and --lookalikes puts readings
+with the same labels in other groups ahead of them, as on a machine with a second network adapter
+or GPU. Only the standard library is used.
+"""
+
+import argparse
+import gzip
+import http.server
+import json
+import random
+import sys
+import threading
+import time
+import zlib
+
+AFTERBURNER_ENTRIES = [
+    ("GPU temperature", "C", 0, 100, 55),
+    ("GPU usage", "%", 0, 100, 60),
+    ("Framerate", "FPS", 0, 500, 144),
+    ("CPU temperature", "C", 0, 100, 50),
+    ("CPU usage", "%", 0, 100, 25),
+    ("Fan speed", "%", 0, 100, 40),
+    ("Core clock", "MHz", 0, 3000, 1800),
+    ("Memory clock", "MHz", 0, 12000, 9500),
+    ("CPU clock", "MHz", 0, 6000, 4500),
+]
+
+# (group, label, unit, min, max, typical)
+HWINFO_READINGS = [
+    ("System", "Physical Memory Used", "MB", 0, 32768, 9000),
+    ("System", "Physical Memory Available", "MB", 0, 32768, 23000),
+    ("ASRock X570 Steel Legend (Nuvoton NCT6796D)", "CPU2", "RPM", 0, 4000, 1800),
+    ("Network: Broadcom 802.11ac Wireless PCIE Full Dongle Adapter", "Current UP rate", "KB/s",
+     0, 50000, 120),
+    ("Network: Broadcom 802.11ac Wireless PCIE Full Dongle Adapter", "Current DL rate", "KB/s",
+     0, 50000, 2400),
+]
+
+SYNTHETIC_GROUPS = [
+    "CPU [#0]: AMD Ryzen 7 5800X",
+    "GPU [#0]: NVIDIA GeForce RTX 3080",
+    "S.M.A.R.T.: Samsung SSD 970 EVO Plus 1TB",
+    "Drive: Samsung SSD 970 EVO Plus 1TB (C:)",
+    "Network: Intel Ethernet Controller I225-V",
+    "Windows Hardware Errors (WHEA)",
+]
+
+SYNTHETIC_LABELS = [
+    ("Core Clock", "MHz", 0, 6000), ("Temperature", "°C", 0, 110),
+    ("Usage", "%", 0, 100), ("Voltage", "V", 0, 2), ("Power", "W", 0, 400),
+    ("Read Rate", "MB/s", 0, 3500), ("Fan", "RPM", 0, 3000),
+]
+
+
+class Sensor:
+    def __init__(self, group, label, unit, low, high, value):
+        self.group, self.label, self.unit = group, label, unit
+        self.low, self.high = float(low), float(high)
+        self.value = self.min = self.max = self.sum = float(value)
+        self.samples = 1
+
+    def drift(self, rng, amount):
+        step = (self.high - self.low) * amount * rng.uniform(-1, 1)
+        self.value = min(self.high, max(self.low, self.value + step))
+        self.min = min(self.min, self.value)
+        self.max = max(self.max, self.value)
+        self.sum += self.value
+        self.samples += 1
+
+
+class Document:
+    """Synthetic sensor state; values move only when refresh() is called."""
+
+    def __init__(self, args):
+        self.rng = random.Random(args.seed)
+        self.drift_amount = args.drift
+        self.afterburner = [Sensor(None, *entry) for entry in AFTERBURNER_ENTRIES]
+        groups = [reading[0] for reading in HWINFO_READINGS]
+        self.groups = list(dict.fromkeys(groups))
+        self.readings = [Sensor(*reading) for reading in HWINFO_READINGS]
+        if args.lookalikes:
+            lookalikes = ["%s (second)" % group for group in self.groups]
+            self.groups = lookalikes + self.groups
+            self.readings = [Sensor("%s (second)" % group, label, unit, low, high, low)
+                             for group, label, unit, low, high, _ in HWINFO_READINGS
+                             ] + self.readings
+
+        padding = max(0, args.readings - len(self.readings))
+        extra_groups = ["%s #%d" % (SYNTHETIC_GROUPS[i % len(SYNTHETIC_GROUPS)], i)
+                        for i in range(max(1, args.groups))]
+        self.groups += extra_groups
+        for i in range(padding):
+            label, unit, low, high = SYNTHETIC_LABELS[i % len(SYNTHETIC_LABELS)]
+            group = extra_groups[i * len(extra_groups) // max(1, padding)]
+            self.readings.append(Sensor(group, "%s %d" % (label, i), unit, low, high,
+                                        self.rng.uniform(low, high)))
+        self.lock = threading.Lock()
+        self.body = None
+        self.poll_time = int(time.time() * 1000)
+
+    def refresh(self):
+        with self.lock:
+            for sensor in self.afterburner + self.readings:
+                sensor.drift(self.rng, self.drift_amount)
+            self.poll_time = int(time.time() * 1000)
+            self.body = None
+
+    def render(self):
+        with self.lock:
+            if self.body is None:
+                self.body = json.dumps(self.to_json(), ensure_ascii=False).encode("utf-8")
+            return self.body
+
+    def to_json(self):
+        group_index = {group: i for i, group in enumerate(self.groups)}
+        sensors = [{
+            "entryIndex": i,
+            "sensorId": 0xF0000000 + i,
+            "sensorInst": 0,
+            "sensorNameOriginal": group,
+            "sensorNameUser": group,
+        } for i, group in enumerate(self.groups)]
+        readings = [{
+            "entryIndex": i,
+            "readingType": 1 + i % 7,
+            "sensorIndex": group_index[sensor.group],
+            "readingId": 0x1000000 + i,
+            "labelOriginal": sensor.label,
+            "labelUser": sensor.label,
+            "unit": sensor.unit,
+            "value": float(sensor.value),
+            "valueMin": float(sensor.min),
+            "valueMax": float(sensor.max),
+            "valueAvg": sensor.sum / sensor.samples,
+        } for i, sensor in enumerate(self.readings)]
+        entries = [{
+            "name": sensor.label,
+            "units": sensor.unit,
+            "localizedName": sensor.label,
+            "localizedUnits": sensor.unit,
+            "recommendedFormat": "%.0f",
+            "data": float(sensor.value),
+            "minLimit": sensor.low,
+            "maxLimit": sensor.high,
+            "flags": 0,
+            "gpu": 0,
+            "srcId": i,
+        } for i, sensor in enumerate(self.afterburner)]
+        return {
+            "hwinfo": {
+                "signature": 1397311314,
+                "version": 2,
+                "revision": 0,
+                "pollTime": self.poll_time,
+                "sensorCount": len(sensors),
+                "readingCount": len(readings),
+                "sensors": sensors,
+                "readings": readings,
+            },
+            "afterburner": {
+                "signature": 1296123981,
+                "version": 131072,
+                "time": self.poll_time // 1000,
+                "entryCount": len(entries),
+                "entries": entries,
+            },
+        }
+
+
+def make_handler(document, args):
+    rng = random.Random(args.seed + 1)
+    state = {"last_refresh": time.monotonic()}
+
+    class Handler(http.server.BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"
+
+        def log_message(self, format, *arguments):
+            if args.verbose:
+                super().log_message(format, *arguments)
+
+        def do_GET(self):
+            if self.path.split("?")[0] != "/json.json":
+                self.send_error(404)
+                return
+
+            now = time.monotonic()
+            if now - state["last_refresh"] >= args.refresh_ms / 1000.0:
+                state["last_refresh"] = now
+                document.refresh()
+            body = document.render()
+
+            if args.latency_ms:
+                time.sleep(args.latency_ms / 1000.0)
+
+            failure = rng.random() < args.fail_rate
+            if failure and rng.random() < 0.5:
+                self.send_error(500, "Injected failure")
+                return
+
+            encoding = None
+            accepted = self.headers.get("Accept-Encoding", "")
+            if args.compress and "gzip" in accepted:
+                body, encoding = gzip.compress(body, 6), "gzip"
+            elif args.compress and "deflate" in accepted:
+                body, encoding = zlib.compress(body, 6), "deflate"
+
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(body)))
+            if encoding:
+                self.send_header("Content-Encoding", encoding)
+            self.end_headers()
+
+            if failure:
+                # Drop the connection halfway through the body.
+                self.wfile.write(body[:len(body) // 2])
+                self.close_connection = True
+                return
+
+            stall_at = min(len(body), args.stall_after) if args.stall_ms else len(body)
+            self.wfile.write(body[:stall_at])
+            if stall_at < len(body):
+                self.wfile.flush()
+                time.sleep(args.stall_ms / 1000.0)
+                self.wfile.write(body[stall_at:])
+
+    return Handler
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=27008)
+    parser.add_argument("--readings", type=int, default=200,
+                        help="total number of hwinfo readings (default 200)")
+    parser.add_argument("--groups", type=int, default=6,
+                        help="synthetic sensor groups the padding readings are spread over")
+    parser.add_argument("--lookalikes", action="store_true",
+                        help="add a group ahead of each real one with the same reading labels")
+    parser.add_argument("--drift", type=float, default=0.01,
+                        help="per refresh value change as a fraction of each sensor's range")
+    parser.add_argument("--refresh-ms", type=int, default=0,
+                        help="only move values this often; bodies in between are identical")
+    parser.add_argument("--latency-ms", type=int, default=0,
+                        help="delay before the response headers")
+    parser.add_argument("--stall-ms", type=int, default=0,
+                        help="pause this long in the middle of the body")
+    parser.add_argument("--stall-after", type=int, default=4096,
+                        help="body bytes sent before the --stall-ms pause")
+    parser.add_argument("--fail-rate", type=float, default=0.0,
+                        help="fraction of requests answered with a 500 or a truncated body")
+    parser.add_argument("--compress", action="store_true",
+                        help="honour Accept-Encoding with gzip or deflate")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--dump", metavar="FILE",
+                        help="write one document to FILE ('-' for stdout) and exit")
+    parser.add_argument("--polls", type=int, default=1,
+                        help="with --dump FILE, also write the next polls (one refresh apart) "
+                             "to FILE.1, FILE.2 and so on")
+    parser.add_argument("--verbose", action="store_true")
+    args = parser.parse_args()
+
+    document = Document(args)
+    if args.dump:
+        if args.dump == "-":
+            sys.stdout.buffer.write(document.render())
+        else:
+            with open(args.dump, "wb") as dump:
+                dump.write(document.render())
+            for poll in range(1, args.polls):
+                document.refresh()
+                with open("%s.%d" % (args.dump, poll), "wb") as dump:
+                    dump.write(document.render())
+        return
+
+    server = http.server.ThreadingHTTPServer((args.host, args.port),
+                                             make_handler(document, args))
+    print("Serving %d readings on http://%s:%d/json.json (%d bytes)" %
+          (len(document.readings), args.host, args.port, len(document.render())), flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
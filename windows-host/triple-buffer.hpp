@@ -0,0 +1,36 @@
+#pragma once
+#include <atomic>
+
+/*
+Lock-free handoff of the latest value from one producer thread to one consumer thread. The
+producer fills back() and publishes it; the consumer calls acquire() to swap the most recently
+published value into front(). Neither side ever waits: with three slots the producer always has
+one to write while the consumer reads another, and whatever the producer gets back after
+publishing is no longer visible to the consumer.
+*/
+template <typename T> struct TripleBuffer {
+    static const unsigned FRESH = 4;
+
+    T slots[3] = {};
+    // Index of the middle slot, with FRESH set while it holds a value the consumer has not seen.
+    std::atomic<unsigned> middle{1};
+    unsigned backIndex = 0;
+    unsigned frontIndex = 2;
+
+    T &back() { return slots[backIndex]; }
+    const T &front() const { return slots[frontIndex]; }
+
+    void publish() {
+        unsigned previous = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel);
+        backIndex = previous & ~FRESH;
+    }
+
+    // Returns false, and leaves front() alone, when nothing was published since the last call.
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH))
+            return false;
+        unsigned previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & ~FRESH;
+        return true;
+    }
+};
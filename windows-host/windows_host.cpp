@@ -1,7 +1,9 @@
 #include "ArduSerial/ArduSerial.h"
 #include "ArduSerial/pch.h"
 #include "json-parser/json.h"
+#include "remotehwinfo-poller.hpp"
 #include "screens.hpp"
+#include <chrono>
 #include <conio.h>
 #include <curl/curl.h>
 #include <mem.h>
@@ -10,131 +12,40 @@
 #include <time.h>
 #include <windows.h>
 
-char jsonDataBuffer[135000];
-int whichScreen = 1;
-int screenCounter = 0;
-
-struct HTTPResponse {
-    char *buffer;
-    CURLcode code;
-    size_t size;
-    char error[CURL_ERROR_SIZE];
-};
-
-static size_t writeCallback(char *contents, size_t chunkSize, size_t chunksCount,
-                            void *writeDestination) {
-    size_t totalSize = chunkSize * chunksCount;
-    struct HTTPResponse *response = (struct HTTPResponse *)writeDestination;
+const int ARDUINO_COM_PORT = 5;
+const int POLL_INTERVAL_MS = 500;
+// Latency budget for a source: past this without a good response the display keeps showing the
+// last good snapshot, marked as stale.
+const int STALE_AFTER_MS = 2000;
+// Samples of every sensor kept per source: enough to cover the screens' history window.
+const unsigned int HISTORY_SAMPLES = SCREEN_HISTORY_WINDOW_MS / POLL_INTERVAL_MS + 1;
 
-    void *largerBuffer = realloc(response->buffer, response->size + totalSize + 1);
-    if (largerBuffer == NULL) {
-        printf("ERROR: could not allocate enough memory for remotehwinfo response");
-        return 0;
-    }
-
-    response->buffer = (char *)largerBuffer;
-    memcpy(&(response->buffer[response->size]), contents, totalSize);
-    response->size += totalSize;
-    response->buffer[response->size] = '\0';
+char jsonDataBuffer[135000];
 
-    return totalSize;
-}
+struct Display {
+    WindowsSerial *serial;
+    struct RemoteHwinfoSource *source;
+    int whichScreen;
+    int screenCounter;
+    bool screenSent;
+    char scrollText[SCROLL_TEXT_LENGTH + 1];
+};
 
-bool requestRemoteHwinfoData(uint16_t remoteHwinfoPort, struct HTTPResponse *response) {
-    CURL *curl = curl_easy_init();
-    if (curl == NULL) {
-        return false;
-    }
-    char url[32 + 1];
-    char urlFormat[] = "http://localhost:%d/json.json";
-    snprintf(url, sizeof(url), urlFormat, remoteHwinfoPort);
-    CURLcode result;
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)response);
-    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, response->error);
-    result = curl_easy_perform(curl);
-    response->code = result;
-    if (strlen(response->error) == 0) {
-        strncpy(response->error, curl_easy_strerror(response->code), CURL_ERROR_SIZE);
-        response->error[CURL_ERROR_SIZE] = 0;
-    }
-    curl_easy_cleanup(curl);
-    return true;
-}
+struct RemoteHwinfoPoller poller;
+struct Display displays[MAX_REMOTEHWINFO_SOURCES];
+int displayCount = 0;
 
-void printArduinoOutput() {
+void printArduinoOutput(WindowsSerial *serial) {
     printf("\n");
     printf("\033[0;32m");
-    while (Serial.available())
-        printf("%c", Serial.read());
+    while (serial->available())
+        printf("%c", serial->read());
     printf("\033[0m\n");
 }
 
-void changeScreen() { ++whichScreen %= 2; }
-
-void updateArduino() {
-    if (!Serial.connected())
-        return;
-    printArduinoOutput();
-    if (screenCounter == 4) {
-        screenCounter = 0;
-        changeScreen();
-        bool success = Serial.print(BLANK_SCREEN);
-        if (!success) {
-            Serial.end();
-            return;
-        }
-        Sleep(300);
-    }
-
-    clock_t t1 = clock();
-
-    struct HTTPResponse response;
-    response.buffer = (char *)malloc(0);
-    response.buffer[0] = 0;
-    response.size = 0;
-    response.code = CURLE_OK;
-    response.error[0] = 0;
-
-    bool success = requestRemoteHwinfoData(27008, &response);
-    if (!success) {
-        fprintf(stderr, "ERROR: Failed to invoke curl");
-        free(response.buffer);
-        return;
-    }
-    if (response.code != CURLE_OK) {
-        fprintf(stderr, "ERROR: %s\n", response.error);
-        free(response.buffer);
-        return;
-    }
-
-    json_value *jsonObject = json_parse((json_char *)response.buffer, response.size);
-    free(response.buffer);
-    if (jsonObject == NULL) {
-        fprintf(stderr, "ERROR: Failed to parse JSON response\n");
-        return;
-    }
-
-    char screen[SCREEN_TEXT_LENGTH + 1];
-    char errorMessage[33 + 1];
-    strncpy(errorMessage, "Happy gaming!", sizeof(errorMessage));
+void changeScreen(struct Display *display) { ++display->whichScreen %= 2; }
 
-    switch (whichScreen) {
-    case 0:
-        success =
-            createScreen1(screen, sizeof(screen), jsonObject, errorMessage, sizeof(errorMessage));
-        break;
-    case 1:
-        success =
-            createScreen2(screen, sizeof(screen), jsonObject, errorMessage, sizeof(errorMessage));
-        break;
-    default:
-        break;
-    }
-
-    char scrollText[SCROLL_TEXT_LENGTH + 1];
-    char timeString[5 + 1];
+void createScrollText(char *scrollText, int scrollTextLength, const char *errorMessage) {
     time_t t = time(NULL);
     struct tm *time = localtime(&t);
     if (time == NULL) {
@@ -148,7 +59,7 @@ void updateArduino() {
         strncpy(greeting, "afternoon", sizeof(greeting));
     else
         strncpy(greeting, "evening", sizeof(greeting));
-    snprintf(scrollText, sizeof(scrollText), "SCLGood %s! It is %02d:%02d  |  %s", greeting,
+    snprintf(scrollText, scrollTextLength, "SCLGood %s! It is %02d:%02d  |  %s", greeting,
              time->tm_hour, time->tm_min, errorMessage);
 
     if (strlen(scrollText) < SCROLL_TEXT_LENGTH)
@@ -156,38 +67,172 @@ void updateArduino() {
 
     while (strlen(scrollText) < SCROLL_TEXT_LENGTH)
         strncat(scrollText, " ", 1);
+}
+
+void sendScreen(struct Display *display) {
+    WindowsSerial *serial = display->serial;
+    display->screenSent = false;
+    if (!serial->connected())
+        return;
+    printArduinoOutput(serial);
+    bool fresh = remoteHwinfoSourceAcquire(display->source);
+    long long silenceMs = remoteHwinfoSourceSilenceMs(display->source);
+    bool stale = !fresh && silenceMs > STALE_AFTER_MS;
+    if (!fresh && !stale)
+        return;
+    if (display->screenCounter == 4) {
+        display->screenCounter = 0;
+        changeScreen(display);
+        bool success = serial->print(BLANK_SCREEN);
+        if (!success) {
+            serial->end();
+            return;
+        }
+        Sleep(300);
+    }
+
+    const SensorSnapshot *snapshot = &display->source->snapshots.front();
+    char screen[SCREEN_TEXT_LENGTH + 1];
+    char errorMessage[33 + 1];
+    strncpy(errorMessage, "Happy gaming!", sizeof(errorMessage));
 
-    json_value_free(jsonObject);
-    printf("%s\n", screen);
-    if (Serial.print(screen) == false) {
-        Serial.end();
+    bool rendered = false;
+    switch (display->whichScreen) {
+    case 0:
+        rendered =
+            createScreen1(screen, sizeof(screen), snapshot, errorMessage, sizeof(errorMessage));
+        break;
+    case 1:
+        rendered =
+            createScreen2(screen, sizeof(screen), snapshot, errorMessage, sizeof(errorMessage));
+        break;
+    default:
+        break;
+    }
+    if (rendered)
+        createHistoryText(errorMessage, sizeof(errorMessage), snapshot, display->whichScreen);
+    if (stale && snapshot->sequence == 0)
+        strncpy(errorMessage, "Error: No RemoteHWInfo data", sizeof(errorMessage));
+    else if (stale)
+        snprintf(errorMessage, sizeof(errorMessage), "Stale: no new data for %llds",
+                 silenceMs / 1000);
+    createScrollText(display->scrollText, sizeof(display->scrollText), errorMessage);
+
+    printf("%s", screen);
+    if (snapshot->sequence != 0) {
+        auto age = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - snapshot->receivedAt);
+        printf(" (sample age %lld ms%s)", (long long)age.count(), stale ? ", stale" : "");
+    }
+    printf("\n");
+    if (serial->print(screen) == false) {
+        serial->end();
         return;
     }
-    screenCounter++;
+    display->screenCounter++;
+    display->screenSent = true;
+}
+
+void sendScrollText(struct Display *display) {
+    if (!display->screenSent)
+        return;
+    if (display->serial->print(display->scrollText) == false)
+        display->serial->end();
+}
+
+// Renders whatever the poller thread published last; fetching and parsing never hold this up.
+void updateArduinos() {
+    clock_t t1 = clock();
+    for (int i = 0; i < displayCount; i++)
+        sendScreen(&displays[i]);
     clock_t t2 = clock();
     printf("Completed in %fs\n", ((double)(t2 - t1) / CLOCKS_PER_SEC));
     Sleep(500);
-    if (Serial.print(scrollText) == false) {
-        Serial.end();
-        return;
-    }
+    for (int i = 0; i < displayCount; i++)
+        sendScrollText(&displays[i]);
     Sleep(500);
 }
 
+// Accepts "port" or "host:port".
+bool parseRemoteHwinfoAddress(const char *address, char *host, int hostLength, uint16_t *port) {
+    const char *colon = strrchr(address, ':');
+    snprintf(host, hostLength, "%s", REMOTEHWINFO_DEFAULT_HOST);
+    if (colon != NULL)
+        snprintf(host, hostLength, "%.*s", (int)(colon - address), address);
+    int portNumber = atoi(colon != NULL ? colon + 1 : address);
+    if (portNumber <= 0 || portNumber > 65535)
+        return false;
+    *port = (uint16_t)portNumber;
+    return true;
+}
+
+bool addDisplay(int comPort, const char *host, uint16_t port) {
+    SensorHistoryConfig history = SCREEN_HISTORY;
+    history.capacity = HISTORY_SAMPLES;
+    struct RemoteHwinfoSource *source =
+        remoteHwinfoPollerAddSource(&poller, host, port, &SCREEN_SENSOR_VIEW, &history,
+                                    &SCREEN_METRICS);
+    if (source == NULL)
+        return false;
+    struct Display *display = &displays[displayCount++];
+    memset(display, 0, sizeof(*display));
+    display->serial = new WindowsSerial(comPort);
+    display->source = source;
+    display->whichScreen = 1;
+    display->serial->begin(9600);
+    return true;
+}
+
 int main(int argc, char **argv) {
-    if (argc > 3 || argc == 0) {
-        fprintf(stderr, "Usage: windows_host.exe arduino_com_port remotehwinfo_port");
+    if (argc % 2 == 0 || argc == 0 || argc - 1 > 2 * MAX_REMOTEHWINFO_SOURCES) {
+        fprintf(stderr, "Usage: windows_host.exe [arduino_com_port [host:]remotehwinfo_port]...");
+        return 1;
     }
     CURLcode code = curl_global_init(CURL_GLOBAL_ALL);
     if (code != 0) {
         fprintf(stderr, "ERROR: Curl failed to initialize: code %d", code);
         return 1;
     }
-    Serial.begin(9600, 5);
-    while (!kbhit()) {
-        updateArduino();
+    if (!remoteHwinfoPollerInit(&poller)) {
+        fprintf(stderr, "ERROR: Failed to create RemoteHWInfo poller");
+        curl_global_cleanup();
+        return 1;
+    }
+    bool success = true;
+    if (argc == 1)
+        success = addDisplay(ARDUINO_COM_PORT, REMOTEHWINFO_DEFAULT_HOST,
+                             REMOTEHWINFO_DEFAULT_PORT);
+    for (int i = 1; success && i + 1 < argc; i += 2) {
+        char host[64 + 1];
+        uint16_t port;
+        success = parseRemoteHwinfoAddress(argv[i + 1], host, sizeof(host), &port) &&
+                  addDisplay(atoi(argv[i]), host, port);
+        if (!success)
+            fprintf(stderr, "ERROR: Invalid RemoteHWInfo address %s", argv[i + 1]);
+    }
+    if (success)
+        success = remoteHwinfoPollerStart(&poller, POLL_INTERVAL_MS);
+    while (success && !kbhit()) {
+        updateArduinos();
+    }
+    remoteHwinfoPollerStop(&poller);
+    for (int i = 0; i < displayCount; i++) {
+        struct RemoteHwinfoClient *client = &displays[i].source->client;
+        unsigned long patched, parsed, hits, misses;
+        remoteHwinfoSourceParseCounts(displays[i].source, &patched, &parsed);
+        remoteHwinfoSourceSensorCounts(displays[i].source, &hits, &misses);
+        printf("%s: %lu polls, %lu unchanged, %lu patched, %lu parsed in full, %lu sensor reads "
+               "by index, %lu by name, %ld connections, %llu bytes received for %llu bytes of "
+               "JSON, %llu bytes of parser arena, %llu bytes of sensor history\n",
+               client->url, client->requestCount, client->unchangedCount, patched, parsed, hits,
+               misses, client->connectCount, (unsigned long long)client->compressedBytes,
+               (unsigned long long)client->decompressedBytes,
+               (unsigned long long)remoteHwinfoSourceArenaHighWater(displays[i].source),
+               (unsigned long long)displays[i].source->history.bytes);
+        displays[i].serial->end();
+        delete displays[i].serial;
     }
-    Serial.end();
+    remoteHwinfoPollerCleanup(&poller);
     curl_global_cleanup();
-    return 0;
+    return success ? 0 : 1;
 }
\ No newline at end of file
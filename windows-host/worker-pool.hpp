@@ -0,0 +1,81 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+A fixed set of threads that run batches of tasks, such as the runs of json_parse_tape_parallel.
+run() hands every task of the batch to whichever thread is free, works on the batch itself as
+well, and returns once all of them have finished: a pool of n - 1 threads runs n tasks at a time.
+*/
+struct WorkerPool {
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable started, finished;
+    void (*task)(void *) = nullptr;
+    void **runs = nullptr;
+    unsigned count = 0;
+    unsigned next = 0;     // the next run to hand out
+    unsigned pending = 0;  // runs handed out or not, that have not finished
+    unsigned long batch = 0;
+    bool stopping = false;
+
+    explicit WorkerPool(unsigned threadCount) {
+        for (unsigned i = 0; i < threadCount; i++)
+            threads.emplace_back([this] { work(); });
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        started.notify_all();
+        for (std::thread &thread : threads)
+            thread.join();
+    }
+
+    void run(void (*batchTask)(void *), void **batchRuns, unsigned batchCount) {
+        std::unique_lock<std::mutex> lock(mutex);
+        task = batchTask;
+        runs = batchRuns;
+        count = pending = batchCount;
+        next = 0;
+        batch++;
+        started.notify_all();
+        runSome(lock);
+        finished.wait(lock, [this] { return pending == 0; });
+    }
+
+    // Matches json_run_parts, with the pool as run_data.
+    static void runParts(void (*batchTask)(void *), void **batchRuns, unsigned int batchCount,
+                         void *pool) {
+        ((WorkerPool *)pool)->run(batchTask, batchRuns, batchCount);
+    }
+
+  private:
+    // Runs tasks until none are left to hand out; called, and returns, with the lock held.
+    void runSome(std::unique_lock<std::mutex> &lock) {
+        while (next < count) {
+            void *run = runs[next++];
+            lock.unlock();
+            task(run);
+            lock.lock();
+            if (--pending == 0)
+                finished.notify_all();
+        }
+    }
+
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex);
+        unsigned long seen = 0;
+        for (;;) {
+            started.wait(lock, [&] { return stopping || batch != seen; });
+            if (stopping)
+                return;
+            seen = batch;
+            runSome(lock);
+        }
+    }
+};